@@ -0,0 +1,187 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+  std::string name;
+  unsigned threads;
+  size_t samples;
+  double seconds;
+  size_t allocations;
+
+  double ns_per_sample() const {
+    return samples == 0 ? 0.0 : seconds * 1e9 / static_cast<double>(samples);
+  }
+  double samples_per_sec() const {
+    return static_cast<double>(samples) / seconds;
+  }
+  double allocs_per_sample() const {
+    return samples == 0 ? 0.0
+                        : static_cast<double>(allocations) /
+                              static_cast<double>(samples);
+  }
+};
+
+// Runs the benchmark build of every registered task, bench_<task> (the
+// task's own source with task_probe.hpp force-included), once at each
+// thread count and collects the throughput, allocation and scaling figures
+// of its sampling phases from the report it writes on exit. Every run gets
+// the same TASK_SEED, so the tasks that stop on a precision target
+// (run_until, find_threshold) draw the same number of samples each time and
+// across commits as long as their results do not change. The output is
+// discarded, and each run gets a scratch directory of its own so that no
+// checkpoint of an earlier run is resumed.
+//
+// Not measured: the work of a task outside its runners (enumeration,
+// printing) and allocations inside the worker processes of a
+// run_reduce(..., Processes) run, whose samples and time still count.
+class BenchSuite {
+ public:
+  BenchSuite(std::filesystem::path dir, std::vector<unsigned> thread_counts)
+      : m_dir(std::move(dir)), m_thread_counts(std::move(thread_counts)) {}
+
+  // Benchmarks bench_<name> run with the command line arguments `args`.
+  void add(std::string name, std::vector<std::string> args = {}) {
+    m_cases.push_back({std::move(name), std::move(args)});
+  }
+
+  // False if any run failed; the others are still measured.
+  bool run(const std::string& filter = "") {
+    bool ok = true;
+    for (const auto& task : m_cases) {
+      if (task.name.find(filter) == std::string::npos) {
+        continue;
+      }
+      for (unsigned threads : m_thread_counts) {
+        auto result = run_once(task, threads);
+        if (!result) {
+          std::println("{:<24} {:>7} failed", task.name, threads);
+          ok = false;
+          continue;
+        }
+        m_results.push_back(*result);
+        print_row(m_results.back());
+      }
+    }
+    return ok;
+  }
+
+  const std::vector<BenchResult>& results() const { return m_results; }
+
+  static void print_header() {
+    std::println("{:<24} {:>7} {:>12} {:>12} {:>14} {:>12} {:>8}",
+                 "benchmark", "threads", "samples", "ns/sample",
+                 "samples/sec", "allocs/smp", "speedup");
+  }
+
+  void write_json(std::FILE* out) const {
+    std::println(out, "{{");
+    std::println(out, "  \"results\": [");
+    for (size_t i = 0; i < m_results.size(); i++) {
+      const auto& r = m_results[i];
+      std::println(out,
+                   "    {{\"name\": \"{}\", \"threads\": {}, \"samples\": {}, "
+                   "\"seconds\": {:.6f}, \"ns_per_sample\": {:.4f}, "
+                   "\"samples_per_sec\": {:.1f}, \"allocs_per_sample\": "
+                   "{:.4f}, \"speedup\": {:.3f}}}{}",
+                   r.name, r.threads, r.samples, r.seconds, r.ns_per_sample(),
+                   r.samples_per_sec(), r.allocs_per_sample(), speedup(r),
+                   i + 1 < m_results.size() ? "," : "");
+    }
+    std::println(out, "  ]");
+    std::println(out, "}}");
+  }
+
+ private:
+  static constexpr const char* kSeed = "20240601";
+
+  struct Case {
+    std::string name;
+    std::vector<std::string> args;
+  };
+
+  std::optional<BenchResult> run_once(const Case& task, unsigned threads) {
+    std::filesystem::path work = m_dir / ("bench_work_" + task.name);
+    std::filesystem::path report = work / "report";
+    std::error_code error;
+    std::filesystem::remove_all(work, error);
+    if (!std::filesystem::create_directory(work, error)) {
+      return std::nullopt;
+    }
+
+    std::string program = (m_dir / ("bench_" + task.name)).string();
+    std::string thread_count = std::to_string(threads);
+    std::vector<char*> argv{program.data()};
+    for (const auto& arg : task.args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+      return std::nullopt;
+    }
+    if (pid == 0) {
+      int null = ::open("/dev/null", O_WRONLY);
+      if (null < 0 || ::dup2(null, STDOUT_FILENO) < 0 ||
+          ::chdir(work.c_str()) != 0 ||
+          ::setenv("TASK_THREADS", thread_count.c_str(), 1) != 0 ||
+          ::setenv("TASK_SEED", kSeed, 1) != 0 ||
+          ::setenv("TASK_BENCH_REPORT", report.c_str(), 1) != 0) {
+        std::_Exit(127);
+      }
+      ::execv(program.c_str(), argv.data());
+      std::_Exit(127);
+    }
+
+    int status = 0;
+    if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+      return std::nullopt;
+    }
+
+    BenchResult result{task.name, threads, 0, 0.0, 0};
+    std::ifstream in(report);
+    if (!(in >> result.samples >> result.allocations >> result.seconds)) {
+      return std::nullopt;
+    }
+    in.close();
+    std::filesystem::remove_all(work, error);
+    return result;
+  }
+
+  // Throughput relative to the first thread count measured for the case.
+  double speedup(const BenchResult& result) const {
+    for (const auto& r : m_results) {
+      if (r.name == result.name) {
+        return r.seconds / result.seconds;
+      }
+    }
+    return 1.0;
+  }
+
+  void print_row(const BenchResult& r) const {
+    std::println("{:<24} {:>7} {:>12} {:>12.3f} {:>14.0f} {:>12.4f} {:>8.2f}",
+                 r.name, r.threads, r.samples, r.ns_per_sample(),
+                 r.samples_per_sec(), r.allocs_per_sample(), speedup(r));
+  }
+
+  std::filesystem::path m_dir;
+  std::vector<unsigned> m_thread_counts;
+  std::vector<Case> m_cases;
+  std::vector<BenchResult> m_results;
+};
+
+#endif  // !BENCH_HPP
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <print>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+// Command lines of the tasks that need one.
+const std::map<std::string, std::vector<std::string>> kTaskArgs = {
+    {"121", {"26", "1000000"}},
+    {"122", {"10"}},
+    {"123", {"5"}},
+    {"232", {"10000000"}},
+};
+
+// Tasks that do not sample through TaskRunner, so there is nothing to
+// measure.
+const std::set<std::string> kSkippedTasks = {"31"};
+
+// Every bench_<task> executable in dir, in task order.
+std::vector<std::string> find_tasks(const std::filesystem::path& dir) {
+  std::vector<std::string> tasks;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    std::string name = entry.path().filename().string();
+    if (entry.is_regular_file() && name.starts_with("bench_") &&
+        name.find('.') == std::string::npos &&
+        !kSkippedTasks.contains(name.substr(6))) {
+      tasks.push_back(name.substr(6));
+    }
+  }
+  std::ranges::sort(tasks, [](const std::string& a, const std::string& b) {
+    return a.size() != b.size() ? a.size() < b.size() : a < b;
+  });
+  return tasks;
+}
+
+std::vector<unsigned> default_thread_counts() {
+  unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<unsigned> counts;
+  for (unsigned t = 1; t < hardware; t *= 2) {
+    counts.push_back(t);
+  }
+  counts.push_back(hardware);
+  return counts;
+}
+
+// A comma-separated list of positive thread counts; nullopt if it is empty
+// or any entry is not such a number.
+std::optional<std::vector<unsigned>> parse_thread_counts(
+    std::string_view list) {
+  std::vector<unsigned> counts;
+  while (true) {
+    size_t comma = list.find(',');
+    std::string_view item = list.substr(0, comma);
+    unsigned count = 0;
+    auto [end, error] =
+        std::from_chars(item.data(), item.data() + item.size(), count);
+    if (error != std::errc{} || end != item.data() + item.size() ||
+        count == 0) {
+      return std::nullopt;
+    }
+    counts.push_back(count);
+    if (comma == std::string_view::npos) {
+      return counts;
+    }
+    list = list.substr(comma + 1);
+  }
+}
+
+void usage(const char* program) {
+  std::print(
+      "Usage: {} [--threads 1,2,4] [--json out.json] [--filter name] "
+      "[--dir build_dir]\n",
+      program);
+}
+
+int main(int argc, char** argv) {
+  std::vector<unsigned> threads = default_thread_counts();
+  std::string json_path;
+  std::string filter;
+  std::filesystem::path dir =
+      std::filesystem::absolute(argv[0]).parent_path();
+
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--help") {
+      usage(argv[0]);
+      return 0;
+    }
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return 1;
+    }
+    if (arg == "--threads") {
+      auto counts = parse_thread_counts(argv[++i]);
+      if (!counts) {
+        std::print("--threads takes a list of positive counts, got '{}'\n",
+                   argv[i]);
+        return 1;
+      }
+      threads = std::move(*counts);
+    } else if (arg == "--json") {
+      json_path = argv[++i];
+    } else if (arg == "--filter") {
+      filter = argv[++i];
+    } else if (arg == "--dir") {
+      dir = std::filesystem::absolute(argv[++i]);
+    } else {
+      std::print("Unknown option {}\n", arg);
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::error_code error;
+  if (!std::filesystem::is_directory(dir, error)) {
+    std::print("{} is not a directory\n", dir.string());
+    return 1;
+  }
+
+  BenchSuite suite(dir, threads);
+  for (const auto& task : find_tasks(dir)) {
+    auto args = kTaskArgs.find(task);
+    suite.add(task, args != kTaskArgs.end() ? args->second
+                                            : std::vector<std::string>{});
+  }
+
+  BenchSuite::print_header();
+  bool ok = suite.run(filter);
+
+  if (!json_path.empty()) {
+    std::FILE* out = std::fopen(json_path.c_str(), "w");
+    if (out == nullptr) {
+      std::print("Cannot open {}\n", json_path);
+      return 1;
+    }
+    suite.write_json(out);
+    if (std::fclose(out) != 0) {
+      std::print("Cannot write {}\n", json_path);
+      return 1;
+    }
+  }
+  return ok ? 0 : 1;
+}
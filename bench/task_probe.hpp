@@ -0,0 +1,61 @@
+#ifndef TASK_PROBE_HPP
+#define TASK_PROBE_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <print>
+
+#include "progress.hpp"
+
+// Force-included into the bench_<task> builds of the src/ tasks (see
+// CMakeLists.txt), which are the task sources unchanged. Measures only the
+// sampling phases of the task, i.e. while a ProgressReporter of one of its
+// runners is alive: the samples those runners finished, the heap
+// allocations made meanwhile and the wall time they took. Enumeration,
+// printing and whatever else the task does between runs is left out. When
+// the process exits the figures are written to the file named by
+// TASK_BENCH_REPORT for task_bench to collect.
+namespace task_probe {
+
+inline std::atomic<size_t> allocations{0};
+
+struct Report {
+  ~Report() {
+    const char* path = std::getenv("TASK_BENCH_REPORT");
+    if (path == nullptr) {
+      return;
+    }
+    if (std::FILE* out = std::fopen(path, "w")) {
+      std::println(out, "{} {} {:.9f}", ProgressReporter::finished(),
+                   allocations.load(), ProgressReporter::busy_seconds());
+      std::fclose(out);
+    }
+  }
+};
+
+// Destroyed after everything of the task.
+static Report report;
+
+}  // namespace task_probe
+
+// Not inlined, so that the compiler never pairs the malloc and free below
+// with the new and delete expressions of the task and warns about a
+// mismatch.
+[[gnu::noinline]] void* operator new(size_t size) {
+  if (ProgressReporter::active()) {
+    task_probe::allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+#endif  // !TASK_PROBE_HPP
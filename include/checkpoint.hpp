@@ -0,0 +1,203 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// Where and how often TaskRunner::run_reduce saves its progress. A run that
+// finds a checkpoint of the same run at `path` resumes from it; the file is
+// removed once the run completes.
+struct Checkpoint {
+  std::string path;
+  // Minimum wall-clock time between two saves.
+  std::chrono::seconds interval{60};
+  // Run-time parameters the experiment depends on (command line arguments,
+  // input files, ...); a checkpoint saved with a different tag is ignored.
+  std::string tag{};
+};
+
+// Binary output for checkpoints. Reducers write their state through
+// save(CheckpointWriter&); values must be trivially copyable and are
+// written in the machine's own representation.
+class CheckpointWriter {
+ public:
+  explicit CheckpointWriter(std::FILE* file) : m_file(file) {}
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void write(const T& value) {
+    m_ok = m_ok && std::fwrite(&value, sizeof(T), 1, m_file) == 1;
+  }
+
+  // Outcome/count pairs, as returned by Tally::entries().
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void write_entries(const std::vector<std::pair<T, size_t>>& entries) {
+    write(static_cast<uint64_t>(entries.size()));
+    for (const auto& [value, count] : entries) {
+      write(value);
+      write(static_cast<uint64_t>(count));
+    }
+  }
+
+  bool ok() const { return m_ok; }
+
+ private:
+  std::FILE* m_file;
+  bool m_ok = true;
+};
+
+// Reads back what CheckpointWriter wrote; ok() turns false on a short or
+// failed read and stays false.
+class CheckpointReader {
+ public:
+  explicit CheckpointReader(std::FILE* file) : m_file(file) {}
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void read(T& value) {
+    m_ok = m_ok && std::fread(&value, sizeof(T), 1, m_file) == 1;
+  }
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  std::vector<std::pair<T, size_t>> read_entries() {
+    uint64_t size = 0;
+    read(size);
+    std::vector<std::pair<T, size_t>> entries;
+    for (uint64_t i = 0; m_ok && i < size; i++) {
+      T value{};
+      uint64_t count = 0;
+      read(value);
+      read(count);
+      entries.emplace_back(value, count);
+    }
+    return entries;
+  }
+
+  bool ok() const { return m_ok; }
+
+ private:
+  std::FILE* m_file;
+  bool m_ok = true;
+};
+
+template <typename R>
+concept Checkpointable = requires(const R& saved, R& loaded,
+                                  CheckpointWriter& out, CheckpointReader& in) {
+  saved.save(out);
+  loaded.load(in);
+};
+
+// Position of a run: the reducer in the file holds blocks [0, next_block)
+// of a run of `simulations` with this seed and block size, of the run
+// identified by `fingerprint` (see checkpoint_fingerprint).
+struct CheckpointHeader {
+  uint64_t seed = 0;
+  uint64_t fingerprint = 0;
+  uint64_t simulations = 0;
+  uint64_t block_size = 0;
+  uint64_t next_block = 0;
+};
+
+// Reads "TRCKPT02" on little-endian machines.
+inline constexpr uint64_t kCheckpointMagic = 0x323054504b435254;
+
+// 64-bit FNV-1a of `bytes`, continuing from `hash`.
+constexpr uint64_t fnv1a(std::string_view bytes,
+                         uint64_t hash = 0xcbf29ce484222325) {
+  for (char c : bytes) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+  }
+  return hash;
+}
+
+// Hash of the running executable, which covers the experiment's code and
+// every constant compiled into it; 0 if it cannot be read.
+inline uint64_t executable_fingerprint() {
+  static const uint64_t fingerprint = [] {
+    std::FILE* file = std::fopen("/proc/self/exe", "rb");
+    if (file == nullptr) {
+      return uint64_t{0};
+    }
+    uint64_t hash = fnv1a({});
+    char buffer[1 << 16];
+    size_t size = 0;
+    while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      hash = fnv1a(std::string_view(buffer, size), hash);
+    }
+    std::fclose(file);
+    return hash;
+  }();
+  return fingerprint;
+}
+
+// Identifies the run a checkpoint belongs to: the experiment, reducer and
+// engine types, the executable they were built into and the checkpoint's
+// run-time tag.
+template <typename E, typename R, typename RNG>
+uint64_t checkpoint_fingerprint(std::string_view tag) {
+  uint64_t hash = fnv1a(typeid(E).name());
+  hash = fnv1a(typeid(R).name(), hash);
+  hash = fnv1a(typeid(RNG).name(), hash);
+  hash = fnv1a(tag, hash);
+  uint64_t executable = executable_fingerprint();
+  return fnv1a(std::string_view(reinterpret_cast<const char*>(&executable),
+                                sizeof(executable)),
+               hash);
+}
+
+// Writes the checkpoint to a temporary file and renames it over `path`, so
+// a crash mid-write leaves the previous checkpoint intact.
+template <Checkpointable R>
+bool save_checkpoint(const std::string& path, const CheckpointHeader& header,
+                     const R& reducer) {
+  std::string temporary = path + ".tmp";
+  std::FILE* file = std::fopen(temporary.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  CheckpointWriter out(file);
+  out.write(kCheckpointMagic);
+  out.write(header);
+  reducer.save(out);
+  bool ok = out.ok() && std::fflush(file) == 0;
+  ok = std::fclose(file) == 0 && ok;
+  return ok && std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// Loads the checkpoint at `path` into `reducer` if it was saved by the run
+// with this `fingerprint`, leaving `reducer` unspecified otherwise. Returns
+// the header, so the caller can tell a checkpoint of another run from none;
+// nullopt when there is none or it is not a readable checkpoint.
+template <Checkpointable R>
+std::optional<CheckpointHeader> load_checkpoint(const std::string& path,
+                                                uint64_t fingerprint,
+                                                R& reducer) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return std::nullopt;
+  }
+  CheckpointReader in(file);
+  uint64_t magic = 0;
+  CheckpointHeader header;
+  in.read(magic);
+  in.read(header);
+  bool ok = in.ok() && magic == kCheckpointMagic;
+  if (ok && header.fingerprint == fingerprint) {
+    reducer.load(in);
+    ok = in.ok();
+  }
+  std::fclose(file);
+  return ok ? std::optional(header) : std::nullopt;
+}
+
+#endif  // !CHECKPOINT_HPP
@@ -0,0 +1,213 @@
+#ifndef COLUMN_EXPORT_HPP
+#define COLUMN_EXPORT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Where TaskRunner::run_reduce streams every sample's outcome. `columns`
+// names the columns of the file, one name per column; left empty, they are
+// called "value" for a scalar outcome and by their index for the elements
+// of a tuple, pair or array.
+struct ResultExport {
+  std::string path;
+  std::vector<std::string> columns{};
+};
+
+// Column file format, all integers in the machine's byte order:
+//
+//   magic        8 bytes "TRCOLS01"
+//   columns      uint32_t C
+//   C times      uint8_t type, uint16_t name length, name bytes
+//   row groups   until the end of the file, each
+//                  uint64_t rows R
+//                  C column chunks of R values, in column order
+//
+// Types: 1 bool (one byte), 2 int8, 3 uint8, 4 int16, 5 uint16, 6 int32,
+// 7 uint32, 8 int64, 9 uint64, 10 float32, 11 float64. Every row group
+// holds one block of the run, in block order, so the file is identical for
+// any thread count, and each column chunk can be read straight into a typed
+// array.
+inline constexpr char kColumnMagic[8] = {'T', 'R', 'C', 'O',
+                                         'L', 'S', '0', '1'};
+
+template <typename T>
+concept ColumnValue = std::is_arithmetic_v<T>;
+
+template <ColumnValue T>
+constexpr uint8_t column_type() {
+  if constexpr (std::same_as<T, bool>) {
+    return 1;
+  } else if constexpr (std::floating_point<T>) {
+    return sizeof(T) == 4 ? 10 : 11;
+  } else {
+    constexpr uint8_t width = sizeof(T) == 1   ? 2
+                              : sizeof(T) == 2 ? 4
+                              : sizeof(T) == 4 ? 6
+                                               : 8;
+    return std::is_signed_v<T> ? width : width + 1;
+  }
+}
+
+// The columns an outcome splits into: a scalar is one column, a tuple, pair
+// or array one column per element.
+template <typename T>
+struct Columns;
+
+template <ColumnValue T>
+struct Columns<T> {
+  using type = std::tuple<T>;
+  static type split(const T& value) { return {value}; }
+};
+
+template <ColumnValue... T>
+struct Columns<std::tuple<T...>> {
+  using type = std::tuple<T...>;
+  static const type& split(const type& value) { return value; }
+};
+
+template <ColumnValue A, ColumnValue B>
+struct Columns<std::pair<A, B>> {
+  using type = std::tuple<A, B>;
+  static type split(const std::pair<A, B>& value) { return value; }
+};
+
+template <ColumnValue T, size_t N>
+struct Columns<std::array<T, N>> {
+  using type = decltype(std::tuple_cat(std::declval<std::array<T, N>>()));
+  static type split(const std::array<T, N>& value) {
+    return std::apply([](const auto&... x) { return type{x...}; }, value);
+  }
+};
+
+template <typename T>
+concept Exportable = requires { typename Columns<T>::type; };
+
+// The outcomes of one block, column by column. bool columns are stored as
+// one byte per value.
+template <Exportable T>
+class ColumnBatch {
+ public:
+  void reserve(size_t rows) {
+    std::apply([&](auto&... column) { (column.reserve(rows), ...); },
+               m_columns);
+  }
+
+  void add(const T& value) {
+    add(Columns<T>::split(value),
+        std::make_index_sequence<std::tuple_size_v<Row>>{});
+  }
+
+  size_t rows() const { return std::get<0>(m_columns).size(); }
+
+  template <typename F>
+  void for_each_column(F&& f) const {
+    std::apply([&](const auto&... column) { (f(column), ...); }, m_columns);
+  }
+
+ private:
+  using Row = typename Columns<T>::type;
+
+  template <typename C>
+  using Stored = std::conditional_t<std::same_as<C, bool>, uint8_t, C>;
+
+  template <typename Tuple>
+  struct Storage;
+
+  template <typename... C>
+  struct Storage<std::tuple<C...>> {
+    using type = std::tuple<std::vector<Stored<C>>...>;
+  };
+
+  template <size_t... I>
+  void add(const Row& row, std::index_sequence<I...>) {
+    (std::get<I>(m_columns).push_back(std::get<I>(row)), ...);
+  }
+
+  typename Storage<Row>::type m_columns;
+};
+
+// Column file being written; see the format above. Batches are appended as
+// row groups with merge(), so a BlockMerger can feed it in block order.
+template <Exportable T>
+class ColumnFile {
+ public:
+  // Throws std::invalid_argument when sink.columns names a different
+  // number of columns than T has, and std::runtime_error when the file
+  // cannot be created or its header written.
+  explicit ColumnFile(const ResultExport& sink) {
+    constexpr size_t kColumns = std::tuple_size_v<Row>;
+    if (!sink.columns.empty() && sink.columns.size() != kColumns) {
+      throw std::invalid_argument(
+          std::to_string(sink.columns.size()) + " names for " +
+          std::to_string(kColumns) + " columns of " + sink.path);
+    }
+    std::vector<std::string> names(kColumns);
+    for (size_t c = 0; c < kColumns; c++) {
+      names[c] = !sink.columns.empty() ? sink.columns[c]
+                 : kColumns == 1       ? "value"
+                                       : std::to_string(c);
+      if (names[c].size() > UINT16_MAX) {
+        throw std::invalid_argument("column name too long for " + sink.path);
+      }
+    }
+
+    m_file = std::fopen(sink.path.c_str(), "wb");
+    if (m_file == nullptr) {
+      throw std::runtime_error("cannot open " + sink.path);
+    }
+    std::fwrite(kColumnMagic, 1, sizeof(kColumnMagic), m_file);
+    write(static_cast<uint32_t>(kColumns));
+    auto types = column_types(std::make_index_sequence<kColumns>{});
+    for (size_t c = 0; c < kColumns; c++) {
+      write(types[c]);
+      write(static_cast<uint16_t>(names[c].size()));
+      std::fwrite(names[c].data(), 1, names[c].size(), m_file);
+    }
+    // Fail before any simulation runs rather than at the end of the run.
+    if (!flush()) {
+      std::fclose(m_file);
+      throw std::runtime_error("cannot write " + sink.path);
+    }
+  }
+
+  ColumnFile(const ColumnFile&) = delete;
+  ColumnFile& operator=(const ColumnFile&) = delete;
+
+  ~ColumnFile() { std::fclose(m_file); }
+
+  void merge(const ColumnBatch<T>& batch) {
+    write(static_cast<uint64_t>(batch.rows()));
+    batch.for_each_column([&](const auto& column) {
+      std::fwrite(column.data(), sizeof(column[0]), column.size(), m_file);
+    });
+  }
+
+  // Writes out what is buffered; false if any write has failed.
+  bool flush() { return std::fflush(m_file) == 0 && std::ferror(m_file) == 0; }
+
+ private:
+  using Row = typename Columns<T>::type;
+
+  template <size_t... I>
+  static std::array<uint8_t, sizeof...(I)> column_types(
+      std::index_sequence<I...>) {
+    return {column_type<std::tuple_element_t<I, Row>>()...};
+  }
+
+  template <typename V>
+  void write(const V& value) {
+    std::fwrite(&value, sizeof(V), 1, m_file);
+  }
+
+  std::FILE* m_file = nullptr;
+};
+
+#endif  // !COLUMN_EXPORT_HPP
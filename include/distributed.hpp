@@ -0,0 +1,298 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "checkpoint.hpp"
+
+// How TaskRunner::run_reduce spreads a run over worker processes.
+struct Processes {
+  unsigned count = std::thread::hardware_concurrency();
+  // Blocks per request; a crashed worker loses at most this many.
+  size_t blocks_per_task = 16;
+  // Longest a worker may take to answer one block before it is taken for
+  // hung, killed, and its unanswered blocks run by the others. Zero waits
+  // forever.
+  std::chrono::seconds reply_timeout{300};
+};
+
+// Block ranges still to be run. Ranges given back by a crashed worker are
+// handed out again before new ones.
+class BlockRanges {
+ public:
+  BlockRanges(size_t blocks, size_t blocks_per_task)
+      : m_blocks(blocks), m_per_task(std::max<size_t>(blocks_per_task, 1)) {}
+
+  // The next range [first, last) to run. Waits while other ranges are in
+  // flight, since they may yet be given back; nullopt once every block is
+  // done.
+  std::optional<std::pair<size_t, size_t>> take() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [&] {
+      return !m_returned.empty() || m_next < m_blocks || m_in_flight == 0;
+    });
+    std::pair<size_t, size_t> range;
+    if (!m_returned.empty()) {
+      range = m_returned.front();
+      m_returned.pop_front();
+    } else if (m_next < m_blocks) {
+      range = {m_next, std::min(m_next + m_per_task, m_blocks)};
+      m_next = range.second;
+    } else {
+      return std::nullopt;
+    }
+    m_in_flight++;
+    return range;
+  }
+
+  // The range last taken by the caller is done.
+  void finish() { give_back(0, 0); }
+
+  // The blocks [first, last) of the caller's range were not done.
+  void give_back(size_t first, size_t last) {
+    std::lock_guard lock(m_mutex);
+    if (first < last) {
+      m_returned.emplace_back(first, last);
+    }
+    m_in_flight--;
+    m_changed.notify_all();
+  }
+
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<std::pair<size_t, size_t>> m_returned;
+  size_t m_blocks;
+  size_t m_per_task;
+  size_t m_next = 0;
+  size_t m_in_flight = 0;
+};
+
+// Forked worker processes, each connected to the coordinator by a Unix
+// stream socket. The coordinator sends requests for block ranges as two
+// uint64_t [first, last); a worker answers every block of a range, in
+// order, with the block index followed by the block's result in checkpoint
+// format. A worker whose socket closes mid-range has crashed, and one that
+// stays silent for longer than the reply timeout is killed as hung; either
+// way the blocks it did not answer go back to the other workers.
+class WorkerPool {
+ public:
+  // Forks `count` workers that run serve(fd) on their end of the socket and
+  // exit. Fork before starting any thread, so the children are copies of a
+  // single-threaded process.
+  template <typename Serve>
+  WorkerPool(unsigned count, Serve&& serve) {
+    try {
+      for (unsigned w = 0; w < std::max(count, 1u); w++) {
+        spawn(serve);
+      }
+    } catch (...) {
+      shutdown();
+      throw;
+    }
+  }
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Closing the sockets tells idle workers to exit.
+  ~WorkerPool() { shutdown(); }
+
+  unsigned size() const { return static_cast<unsigned>(m_workers.size()); }
+
+  // Runs the blocks [0, blocks) on the workers, one coordinating thread per
+  // worker. receive(worker, block, in) reads the block's result from `in`
+  // and returns in.ok(). Blocks may arrive in any order but each is
+  // received once. A worker that does not answer a block within
+  // `reply_timeout` (zero for no limit) is killed. False if every worker
+  // died before all blocks were done.
+  template <typename Receive>
+  bool distribute(size_t blocks, size_t blocks_per_task,
+                  std::chrono::seconds reply_timeout, Receive&& receive) {
+    BlockRanges ranges(blocks, blocks_per_task);
+    std::atomic<size_t> received{0};
+
+    auto coordinate = [&](unsigned w) {
+      Worker& worker = m_workers[w];
+      // Reads of the replies fail once the timeout passes without a byte.
+      timeval timeout{static_cast<time_t>(reply_timeout.count()), 0};
+      if (::setsockopt(worker.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                       sizeof(timeout)) != 0) {
+        ::kill(worker.pid, SIGKILL);
+        return;
+      }
+      CheckpointReader in(worker.replies);
+      while (auto range = ranges.take()) {
+        auto [first, last] = *range;
+        const uint64_t request[2] = {first, last};
+        size_t block = first;
+        if (send_all(worker.fd, request, sizeof(request))) {
+          for (; block < last; block++) {
+            uint64_t index = 0;
+            in.read(index);
+            if (!in.ok() || index != block || !receive(w, block, in)) {
+              break;
+            }
+            received.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+        if (block < last) {
+          // Crashed, hung or sent garbage; make sure it is gone before its
+          // blocks run elsewhere, so that shutdown() does not wait on it.
+          ::kill(worker.pid, SIGKILL);
+          ranges.give_back(block, last);
+          return;
+        }
+        ranges.finish();
+      }
+    };
+
+    {
+      std::vector<std::jthread> pool;
+      pool.reserve(m_workers.size());
+      for (unsigned w = 0; w < size(); w++) {
+        pool.emplace_back(coordinate, w);
+      }
+    }
+    return received.load() == blocks;
+  }
+
+ private:
+  struct Worker {
+    pid_t pid;
+    int fd;
+    // Buffered reader over fd for the replies.
+    std::FILE* replies;
+  };
+
+  template <typename Serve>
+  void spawn(Serve& serve) {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      throw std::system_error(errno, std::generic_category(), "socketpair");
+    }
+    pid_t pid = ::fork();
+    if (pid < 0) {
+      int error = errno;
+      ::close(fds[0]);
+      ::close(fds[1]);
+      throw std::system_error(error, std::generic_category(), "fork");
+    }
+    if (pid == 0) {
+      // Keep only this worker's own socket, so that a sibling sees its
+      // socket close when the coordinator closes it.
+      ::close(fds[0]);
+      for (const auto& worker : m_workers) {
+        ::close(worker.fd);
+      }
+      int status = 0;
+      try {
+        serve(fds[1]);
+      } catch (...) {
+        status = EXIT_FAILURE;
+      }
+      std::_Exit(status);
+    }
+    ::close(fds[1]);
+    m_workers.push_back({pid, fds[0], ::fdopen(fds[0], "rb")});
+  }
+
+  void shutdown() {
+    for (const auto& worker : m_workers) {
+      if (worker.replies != nullptr) {
+        std::fclose(worker.replies);
+      } else {
+        ::close(worker.fd);
+      }
+    }
+    for (const auto& worker : m_workers) {
+      ::waitpid(worker.pid, nullptr, 0);
+    }
+    m_workers.clear();
+  }
+
+  // Writes all of data; false once the peer is gone. MSG_NOSIGNAL keeps a
+  // crashed worker from taking the coordinator down with SIGPIPE.
+  static bool send_all(int fd, const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0) {
+      ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+      if (sent <= 0) {
+        return false;
+      }
+      bytes += sent;
+      size -= static_cast<size_t>(sent);
+    }
+    return true;
+  }
+
+  std::vector<Worker> m_workers;
+};
+
+// Body of a worker process: answers every request for blocks [first, last)
+// on `fd`, block by block, with the index followed by whatever
+// compute(block, out) writes. Returns when the coordinator closes the
+// socket.
+template <typename Compute>
+void serve_blocks(int fd, Compute&& compute) {
+  std::FILE* replies = ::fdopen(fd, "wb");
+  if (replies == nullptr) {
+    ::close(fd);
+    return;
+  }
+  CheckpointWriter out(replies);
+  uint64_t request[2];
+  auto receive = [&] {
+    auto bytes = reinterpret_cast<char*>(request);
+    for (size_t got = 0; got < sizeof(request);) {
+      ssize_t n = ::recv(fd, bytes + got, sizeof(request) - got, 0);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      got += static_cast<size_t>(n);
+    }
+    return true;
+  };
+
+  bool connected = true;
+  while (connected && receive()) {
+    for (uint64_t block = request[0]; connected && block < request[1];
+         block++) {
+      out.write(block);
+      compute(static_cast<size_t>(block), out);
+      // Flushed per block so the coordinator keeps what arrived if this
+      // worker dies later in the range.
+      connected = out.ok() && std::fflush(replies) == 0;
+    }
+  }
+  std::fclose(replies);
+}
+
+#endif  // !DISTRIBUTED_HPP
@@ -0,0 +1,310 @@
+#ifndef ENGINES_HPP
+#define ENGINES_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Drop-in std::uniform_random_bit_generator engines for TaskRunner. All of
+// them produce 64-bit outputs, keep a few words of state, and can be
+// constructed from (seed, stream) so every block of a run gets its own
+// independent substream.
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+// xoshiro256++ by Blackman and Vigna: 256 bits of state, period 2^256 - 1.
+class Xoshiro256pp {
+ public:
+  using result_type = uint64_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  constexpr Xoshiro256pp() : Xoshiro256pp(0) {}
+
+  constexpr explicit Xoshiro256pp(uint64_t seed) { this->seed(seed); }
+
+  // Streams are seeded from a hash of (seed, stream); with a 2^256 period
+  // overlapping substreams are not a practical concern. Use jump() for
+  // provably disjoint sequences.
+  constexpr Xoshiro256pp(uint64_t seed, uint64_t stream) {
+    uint64_t mix = stream;
+    this->seed(seed ^ splitmix64(mix));
+  }
+
+  // Starts from a raw state, which must not be all zero.
+  constexpr explicit Xoshiro256pp(const std::array<uint64_t, 4>& state)
+      : m_s(state) {}
+
+  template <typename SeedSeq>
+    requires requires(SeedSeq& seq, uint32_t* out) { seq.generate(out, out); }
+  explicit Xoshiro256pp(SeedSeq& seq) {
+    std::array<uint32_t, 8> words;
+    seq.generate(words.begin(), words.end());
+    for (size_t i = 0; i < 4; i++) {
+      m_s[i] = (static_cast<uint64_t>(words[2 * i]) << 32) | words[2 * i + 1];
+    }
+    if (m_s == std::array<uint64_t, 4>{}) {
+      m_s[0] = 1;
+    }
+  }
+
+  constexpr void seed(uint64_t seed) {
+    for (auto& word : m_s) {
+      word = splitmix64(seed);
+    }
+  }
+
+  constexpr result_type operator()() {
+    uint64_t result = std::rotl(m_s[0] + m_s[3], 23) + m_s[0];
+    uint64_t t = m_s[1] << 17;
+    m_s[2] ^= m_s[0];
+    m_s[3] ^= m_s[1];
+    m_s[1] ^= m_s[2];
+    m_s[0] ^= m_s[3];
+    m_s[2] ^= t;
+    m_s[3] = std::rotl(m_s[3], 45);
+    return result;
+  }
+
+  constexpr void discard(uint64_t n) {
+    for (; n > 0; n--) {
+      (*this)();
+    }
+  }
+
+  // Equivalent to 2^128 calls; gives 2^128 non-overlapping subsequences.
+  constexpr void jump() {
+    apply_jump({0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C, 0xA9582618E03FC9AA,
+                0x39ABDC4529B1661C});
+  }
+
+  // Equivalent to 2^192 calls.
+  constexpr void long_jump() {
+    apply_jump({0x76E15D3EFEFDCBBF, 0xC5004E441C522FB3, 0x77710069854EE241,
+                0x39109BB02ACBE635});
+  }
+
+  friend bool operator==(const Xoshiro256pp&, const Xoshiro256pp&) = default;
+
+ private:
+  constexpr void apply_jump(const std::array<uint64_t, 4>& polynomial) {
+    std::array<uint64_t, 4> s{};
+    for (uint64_t word : polynomial) {
+      for (int b = 0; b < 64; b++) {
+        if (word & (uint64_t{1} << b)) {
+          for (size_t i = 0; i < 4; i++) {
+            s[i] ^= m_s[i];
+          }
+        }
+        (*this)();
+      }
+    }
+    m_s = s;
+  }
+
+  std::array<uint64_t, 4> m_s;
+};
+
+// PCG64 (XSL-RR 128/64) by O'Neill: a 128-bit LCG with a permuted output.
+// The stream selects the LCG increment, giving 2^127 distinct sequences.
+class Pcg64 {
+ public:
+  using result_type = uint64_t;
+  using uint128 = unsigned __int128;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  constexpr Pcg64() : Pcg64(0x853C49E6748FEA9B, 0xDA3E39CB94B95BDB) {}
+
+  constexpr explicit Pcg64(uint64_t seed) : Pcg64(seed, 0xDA3E39CB94B95BDB) {}
+
+  constexpr Pcg64(uint64_t seed, uint64_t stream) { this->seed(seed, stream); }
+
+  template <typename SeedSeq>
+    requires requires(SeedSeq& seq, uint32_t* out) { seq.generate(out, out); }
+  explicit Pcg64(SeedSeq& seq) {
+    std::array<uint32_t, 4> words;
+    seq.generate(words.begin(), words.end());
+    seed((static_cast<uint64_t>(words[0]) << 32) | words[1],
+         (static_cast<uint64_t>(words[2]) << 32) | words[3]);
+  }
+
+  constexpr void seed(uint64_t seed, uint64_t stream) {
+    m_inc = (static_cast<uint128>(stream) << 1) | 1;
+    m_state = 0;
+    step();
+    m_state += seed;
+    step();
+  }
+
+  constexpr result_type operator()() {
+    step();
+    auto high = static_cast<uint64_t>(m_state >> 64);
+    auto low = static_cast<uint64_t>(m_state);
+    return std::rotr(high ^ low, static_cast<int>(m_state >> 122));
+  }
+
+  // Jumps ahead by n outputs in O(log n) (Brown, "Random Number Generation
+  // with Arbitrary Strides").
+  constexpr void discard(uint64_t n) { advance(n); }
+
+  constexpr void advance(uint128 delta) {
+    uint128 acc_mult = 1;
+    uint128 acc_plus = 0;
+    uint128 cur_mult = kMultiplier;
+    uint128 cur_plus = m_inc;
+    while (delta > 0) {
+      if (delta & 1) {
+        acc_mult *= cur_mult;
+        acc_plus = acc_plus * cur_mult + cur_plus;
+      }
+      cur_plus = (cur_mult + 1) * cur_plus;
+      cur_mult *= cur_mult;
+      delta >>= 1;
+    }
+    m_state = acc_mult * m_state + acc_plus;
+  }
+
+  friend bool operator==(const Pcg64&, const Pcg64&) = default;
+
+ private:
+  static constexpr uint128 kMultiplier =
+      (static_cast<uint128>(0x2360ED051FC65DA4) << 64) | 0x4385DF649FCCF645;
+
+  constexpr void step() { m_state = m_state * kMultiplier + m_inc; }
+
+  uint128 m_state;
+  uint128 m_inc;
+};
+
+// Philox4x32-10 by Salmon et al.: a counter-based engine. The output is a
+// pure function of (key, counter), so any position of any stream can be
+// reached in O(1). The seed is the key; the stream occupies the upper half
+// of the counter and the position within it the lower half.
+class Philox4x32 {
+ public:
+  using result_type = uint64_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  constexpr Philox4x32() : Philox4x32(0) {}
+
+  constexpr explicit Philox4x32(uint64_t seed) : Philox4x32(seed, 0) {}
+
+  constexpr Philox4x32(uint64_t seed, uint64_t stream)
+      : m_key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {
+    seek(stream);
+  }
+
+  template <typename SeedSeq>
+    requires requires(SeedSeq& seq, uint32_t* out) { seq.generate(out, out); }
+  explicit Philox4x32(SeedSeq& seq) {
+    std::array<uint32_t, 4> words;
+    seq.generate(words.begin(), words.end());
+    m_key = {words[0], words[1]};
+    seek((static_cast<uint64_t>(words[2]) << 32) | words[3]);
+  }
+
+  // Moves to `position` outputs into `stream`.
+  constexpr void seek(uint64_t stream, uint64_t position = 0) {
+    m_stream = stream;
+    m_block = position / 2;
+    m_index = 2;
+    if (position % 2 != 0) {
+      refill();
+      m_index = 1;
+    }
+  }
+
+  constexpr result_type operator()() {
+    if (m_index == 2) {
+      refill();
+    }
+    return m_buffer[m_index++];
+  }
+
+  constexpr void discard(uint64_t n) { seek(m_stream, position() + n); }
+
+  // Number of outputs already taken from the current stream.
+  constexpr uint64_t position() const { return m_block * 2 - (2 - m_index); }
+
+  friend bool operator==(const Philox4x32& a, const Philox4x32& b) {
+    return a.m_key == b.m_key && a.m_stream == b.m_stream &&
+           a.position() == b.position();
+  }
+
+ private:
+  static constexpr uint32_t kMul0 = 0xD2511F53;
+  static constexpr uint32_t kMul1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  constexpr void refill() {
+    std::array<uint32_t, 4> c = {
+        static_cast<uint32_t>(m_block), static_cast<uint32_t>(m_block >> 32),
+        static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32)};
+    std::array<uint32_t, 2> k = m_key;
+    for (int round = 0; round < 10; round++) {
+      uint64_t p0 = static_cast<uint64_t>(kMul0) * c[0];
+      uint64_t p1 = static_cast<uint64_t>(kMul1) * c[2];
+      c = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k[0],
+           static_cast<uint32_t>(p1),
+           static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k[1],
+           static_cast<uint32_t>(p0)};
+      k[0] += kWeyl0;
+      k[1] += kWeyl1;
+    }
+    m_buffer[0] = (static_cast<uint64_t>(c[1]) << 32) | c[0];
+    m_buffer[1] = (static_cast<uint64_t>(c[3]) << 32) | c[2];
+    m_block++;
+    m_index = 0;
+  }
+
+  std::array<uint32_t, 2> m_key;
+  uint64_t m_stream = 0;
+  uint64_t m_block = 0;
+  std::array<uint64_t, 2> m_buffer{};
+  uint32_t m_index = 2;
+};
+
+// Known-answer checks against the reference implementations: xoshiro256++
+// from the state {1, 2, 3, 4}, pcg64 seeded with 42 on stream 54, and the
+// Philox4x32-10 test vector with zero counter and key. The skip-ahead paths
+// must land on the same outputs as stepping.
+static_assert([] {
+  Xoshiro256pp rng({1, 2, 3, 4});
+  return rng() == 41943041 && rng() == 58720359 &&
+         rng() == 3588806011781223 && rng() == 3591011842654386;
+}());
+static_assert([] {
+  Pcg64 rng(42, 54);
+  Pcg64 skipped(42, 54);
+  skipped.discard(5);
+  return rng() == 0x86B1DA1D72062B68 && rng() == 0x1304AA46C9853D39 &&
+         rng() == 0xA3670E9E0DD50358 && skipped() == 0x606121F8E3919196;
+}());
+static_assert([] {
+  Philox4x32 rng(0, 0);
+  Philox4x32 skipped(0, 0);
+  skipped.discard(1);
+  return rng() == 0xE169C58D6627E8D5 && rng() == 0x9B00DBD8BC57AC4C &&
+         skipped() == 0x9B00DBD8BC57AC4C;
+}());
+
+#endif  // !ENGINES_HPP
@@ -0,0 +1,260 @@
+#ifndef ENUMERATE_HPP
+#define ENUMERATE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sampling.hpp"
+#include "scratch_arena.hpp"
+
+// Engine that walks every sequence of random choices an experiment can make
+// instead of sampling one. The experiment is replayed once per path: choices
+// already on the path are returned as recorded, and the first choice past it
+// takes branch 0. Afterwards next_path() advances the path like an odometer,
+// so successive replays visit the whole choice tree depth-first.
+//
+// Only draws made through uniform_index, uniform_int, bernoulli and the
+// samplers built on them can be enumerated. Asking for raw bits, or going
+// deeper than kMaxDepth choices, throws NotEnumerable.
+class ChoiceEnumerator {
+ public:
+  using result_type = uint64_t;
+
+  struct NotEnumerable {};
+
+  static constexpr size_t kMaxDepth = 1024;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  ChoiceEnumerator() = default;
+
+  // Restricts the walk to the subtree below a first choice of `first` out
+  // of `arity` branches.
+  ChoiceEnumerator(size_t first, size_t arity) : m_prefix(1) {
+    m_path.push_back({first, arity});
+  }
+
+  result_type operator()() { throw NotEnumerable{}; }
+
+  size_t choose(size_t n) {
+    size_t branch = take(n);
+    m_weight /= static_cast<double>(n);
+    return branch;
+  }
+
+  bool bernoulli(double p) {
+    if (p <= 0.0 || p >= 1.0) {
+      return p >= 1.0;
+    }
+    bool hit = take(2) == 0;
+    m_weight *= hit ? p : 1.0 - p;
+    return hit;
+  }
+
+  // Probability of the path replayed since the last begin_path().
+  double weight() const { return m_weight; }
+
+  // Depth and arity of the choices on the current path.
+  size_t depth() const { return m_path.size(); }
+  size_t arity(size_t depth) const { return m_path[depth].arity; }
+
+  void begin_path() {
+    m_depth = 0;
+    m_weight = 1.0;
+  }
+
+  // Moves to the next path of the subtree; false once it is exhausted.
+  bool next_path() {
+    m_path.resize(m_depth);
+    while (m_path.size() > m_prefix &&
+           m_path.back().branch + 1 == m_path.back().arity) {
+      m_path.pop_back();
+    }
+    if (m_path.size() == m_prefix) {
+      return false;
+    }
+    m_path.back().branch++;
+    return true;
+  }
+
+ private:
+  struct Choice {
+    size_t branch;
+    size_t arity;
+  };
+
+  size_t take(size_t arity) {
+    if (m_depth == m_path.size()) {
+      if (m_depth == kMaxDepth) {
+        throw NotEnumerable{};
+      }
+      // Not push_back, whose growth path GCC 12 flags with a false
+      // -Warray-bounds once this is inlined into an experiment.
+      m_path.resize(m_depth + 1);
+      m_path.back() = {0, arity};
+    }
+    return m_path[m_depth++].branch;
+  }
+
+  std::vector<Choice> m_path;
+  size_t m_prefix = 0;
+  size_t m_depth = 0;
+  double m_weight = 1.0;
+};
+
+// Exact outcome distribution of an experiment: one entry per path of its
+// choice tree with the path's probability. Outcomes reached by several paths
+// appear several times.
+template <typename T>
+class Enumeration {
+ public:
+  void add(T outcome, double probability) {
+    m_outcomes.emplace_back(std::move(outcome), probability);
+  }
+
+  void merge(const Enumeration& other) {
+    m_outcomes.insert(m_outcomes.end(), other.m_outcomes.begin(),
+                      other.m_outcomes.end());
+  }
+
+  // Probability that the outcome satisfies pred.
+  template <typename Pred>
+  double probability(Pred&& pred) const {
+    double sum = 0.0;
+    for (const auto& [outcome, probability] : m_outcomes) {
+      if (pred(outcome)) {
+        sum += probability;
+      }
+    }
+    return sum;
+  }
+
+  // Probability of the outcome `value`.
+  double operator[](const T& value) const {
+    return probability([&](const T& outcome) { return outcome == value; });
+  }
+
+  size_t paths() const { return m_outcomes.size(); }
+
+  const std::vector<std::pair<T, double>>& outcomes() const {
+    return m_outcomes;
+  }
+
+ private:
+  std::vector<std::pair<T, double>> m_outcomes;
+};
+
+template <typename E>
+using enumeration_result_t = typename std::conditional_t<
+    std::invocable<E, ChoiceEnumerator&, ScratchArena&>,
+    std::invoke_result<E, ChoiceEnumerator&, ScratchArena&>,
+    std::invoke_result<E, ChoiceEnumerator&>>::type;
+
+// Replays the experiment along the enumerator's current path.
+template <typename E>
+auto replay_path(E& experiment, ChoiceEnumerator& choices,
+                 ScratchArena& scratch) {
+  choices.begin_path();
+  if constexpr (std::invocable<E&, ChoiceEnumerator&, ScratchArena&>) {
+    auto result = experiment(choices, scratch);
+    scratch.reset();
+    return result;
+  } else {
+    return experiment(choices);
+  }
+}
+
+// Enumerates every path of the experiment's choice tree, giving up (nullopt)
+// when there are more than max_paths or the experiment draws in a way that
+// cannot be enumerated. The subtrees below the first choice are walked on up
+// to `threads` threads and concatenated in branch order, so the result does
+// not depend on the thread count.
+template <typename E, typename T = enumeration_result_t<E>>
+std::optional<Enumeration<T>> enumerate(const E& experiment, size_t max_paths,
+                                        unsigned threads = 1) {
+  std::atomic<size_t> paths{0};
+  std::atomic<bool> failed{false};
+
+  // Walks one subtree into out; false if the enumeration has to be
+  // abandoned.
+  auto walk = [&](ChoiceEnumerator& choices, Enumeration<T>& out) {
+    E local(experiment);
+    ScratchArena scratch;
+    try {
+      do {
+        if (failed.load(std::memory_order_relaxed) ||
+            paths.fetch_add(1, std::memory_order_relaxed) >= max_paths) {
+          return false;
+        }
+        T outcome = replay_path(local, choices, scratch);
+        out.add(std::move(outcome), choices.weight());
+      } while (choices.next_path());
+    } catch (const ChoiceEnumerator::NotEnumerable&) {
+      return false;
+    }
+    return true;
+  };
+
+  // The first path tells how many branches the first choice has.
+  Enumeration<T> first_path;
+  ChoiceEnumerator probe;
+  {
+    E local(experiment);
+    ScratchArena scratch;
+    try {
+      T outcome = replay_path(local, probe, scratch);
+      first_path.add(std::move(outcome), probe.weight());
+    } catch (const ChoiceEnumerator::NotEnumerable&) {
+      return std::nullopt;
+    }
+  }
+  if (probe.depth() == 0) {
+    return first_path;
+  }
+
+  const size_t arity = probe.arity(0);
+  std::vector<Enumeration<T>> subtrees(arity);
+  std::atomic<size_t> next_branch{0};
+
+  auto work = [&] {
+    for (size_t branch = next_branch.fetch_add(1); branch < arity;
+         branch = next_branch.fetch_add(1)) {
+      ChoiceEnumerator choices(branch, arity);
+      if (!walk(choices, subtrees[branch])) {
+        failed = true;
+        return;
+      }
+    }
+  };
+
+  {
+    std::vector<std::jthread> pool;
+    unsigned workers = static_cast<unsigned>(
+        std::clamp<size_t>(arity, 1, std::max(threads, 1u)));
+    for (unsigned w = 1; w < workers; w++) {
+      pool.emplace_back(work);
+    }
+    work();
+  }
+
+  if (failed) {
+    return std::nullopt;
+  }
+  Enumeration<T> result;
+  for (const auto& subtree : subtrees) {
+    result.merge(subtree);
+  }
+  return result;
+}
+
+#endif  // !ENUMERATE_HPP
@@ -0,0 +1,124 @@
+#ifndef ESTIMATE_HPP
+#define ESTIMATE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+#include "reducers.hpp"
+
+// Quantile of the standard normal distribution, by Newton's method on
+// Phi(z) = erfc(-z / sqrt 2) / 2.
+inline double normal_quantile(double p) {
+  double z = 0.0;
+  for (int i = 0; i < 50; i++) {
+    double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+    double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * std::numbers::pi);
+    double step = (cdf - p) / pdf;
+    z -= step;
+    if (std::abs(step) < 1e-12) {
+      break;
+    }
+  }
+  return z;
+}
+
+// Quantile of Student's t distribution with `dof` degrees of freedom, by
+// Newton's method on its CDF, which integrates the density from 0 with
+// Simpson's rule. Approaches normal_quantile as dof grows.
+inline double student_t_quantile(double p, double dof) {
+  // log(Gamma((dof + 1) / 2) / Gamma(dof / 2)); the asymptotic series
+  // avoids the cancellation between two large lgamma values.
+  double half = dof / 2.0;
+  double log_ratio = half < 100.0 ? std::lgamma(half + 0.5) - std::lgamma(half)
+                                  : 0.5 * std::log(half) - 1.0 / (8.0 * half) +
+                                        1.0 / (192.0 * half * half * half);
+  double log_norm = log_ratio - 0.5 * std::log(dof * std::numbers::pi);
+  auto pdf = [&](double t) {
+    return std::exp(log_norm - (dof + 1.0) / 2.0 * std::log1p(t * t / dof));
+  };
+  auto cdf = [&](double t) {
+    const int steps = 1000;
+    double h = t / steps;
+    double sum = pdf(0.0) + pdf(t);
+    for (int i = 1; i < steps; i++) {
+      sum += (i % 2 != 0 ? 4.0 : 2.0) * pdf(i * h);
+    }
+    return 0.5 + sum * h / 3.0;
+  };
+
+  double t = normal_quantile(p);
+  for (int i = 0; i < 50; i++) {
+    double step = (cdf(t) - p) / pdf(t);
+    t -= step;
+    if (std::abs(step) < 1e-12) {
+      break;
+    }
+  }
+  return t;
+}
+
+// A Monte Carlo estimate with its confidence interval mean +- half_width.
+struct Estimate {
+  double mean = 0.0;
+  double std_error = 0.0;
+  double half_width = 0.0;
+  double confidence = 0.0;
+  size_t simulations = 0;
+  bool converged = false;
+  // Variance of plain sampling with the same number of simulations divided
+  // by the variance actually achieved; above 1 when a variance reduction
+  // technique paid off.
+  double variance_reduction = 1.0;
+
+  static Estimate from(const MeanVariance& stats, double confidence) {
+    Estimate estimate;
+    estimate.mean = stats.mean();
+    estimate.std_error = stats.std_error();
+    estimate.half_width =
+        normal_quantile(0.5 + confidence / 2.0) * estimate.std_error;
+    estimate.confidence = confidence;
+    estimate.simulations = stats.count();
+    return estimate;
+  }
+
+  // Estimate of the probability of an event seen `hits` times in `total`
+  // simulations; the same as from() on their 0/1 indicators.
+  static Estimate proportion(size_t hits, size_t total, double confidence) {
+    Estimate estimate;
+    double n = static_cast<double>(total);
+    estimate.mean = total == 0 ? 0.0 : static_cast<double>(hits) / n;
+    estimate.std_error =
+        total < 2 ? 0.0
+                  : std::sqrt(estimate.mean * (1.0 - estimate.mean) / (n - 1));
+    estimate.half_width =
+        normal_quantile(0.5 + confidence / 2.0) * estimate.std_error;
+    estimate.confidence = confidence;
+    estimate.simulations = total;
+    return estimate;
+  }
+};
+
+// Stopping rule for TaskRunner::run_until: stop once the confidence interval
+// is narrower than half_width, or than relative_error * |mean|. A target of
+// zero is disabled. An estimate with zero observed variance never counts as
+// converged, since that usually means the event has simply not been seen
+// yet.
+struct Precision {
+  double half_width = 0.0;
+  double relative_error = 0.0;
+  double confidence = 0.95;
+  // Blocks simulated between two checks; 0 means one block per thread.
+  size_t blocks_per_check = 0;
+
+  bool reached(const Estimate& estimate) const {
+    if (estimate.std_error <= 0.0) {
+      return false;
+    }
+    return (half_width > 0.0 && estimate.half_width <= half_width) ||
+           (relative_error > 0.0 &&
+            estimate.half_width <= relative_error * std::abs(estimate.mean));
+  }
+};
+
+#endif  // !ESTIMATE_HPP
@@ -0,0 +1,95 @@
+#ifndef MULTISET_SHAPE_HPP
+#define MULTISET_SHAPE_HPP
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+
+// Sorts a small fixed-size array in place with an odd-even transposition
+// network: K rounds of independent compare-exchanges that the compiler
+// unrolls into branch-free min/max for the sizes of a hand of cards.
+template <typename T, size_t K, typename Less = std::less<>>
+constexpr void sort_network(std::array<T, K>& values, Less less = {}) {
+  for (size_t round = 0; round < K; round++) {
+    for (size_t i = round % 2; i + 1 < K; i += 2) {
+      T low = less(values[i + 1], values[i]) ? values[i + 1] : values[i];
+      T high = less(values[i + 1], values[i]) ? values[i] : values[i + 1];
+      values[i] = low;
+      values[i + 1] = high;
+    }
+  }
+}
+
+// Shape of a multiset of K draws: how it splits into groups of equal values,
+// as group sizes in decreasing order. Four cards of values {7, 2, 7, 7} have
+// shape {3, 1}, a full house {3, 2}, five distinct cards {1, 1, 1, 1, 1}.
+// Shapes are small trivially copyable values, so they can be compared with
+// constants, counted with events() or tallied with Histogram.
+template <size_t K>
+class MultisetShape {
+ public:
+  constexpr MultisetShape() = default;
+
+  // Group sizes in any order, zero for no group; they should add up to K.
+  constexpr explicit MultisetShape(const std::array<uint8_t, K>& groups)
+      : m_groups(groups) {
+    sort_network(m_groups, std::greater<>{});
+  }
+
+  constexpr MultisetShape(std::initializer_list<uint8_t> groups) {
+    std::copy_n(groups.begin(), std::min(groups.size(), K), m_groups.begin());
+    sort_network(m_groups, std::greater<>{});
+  }
+
+  // Number of groups, i.e. distinct values.
+  constexpr size_t groups() const {
+    return static_cast<size_t>(
+        std::count_if(m_groups.begin(), m_groups.end(),
+                      [](uint8_t size) { return size != 0; }));
+  }
+
+  // Size of the i-th largest group, 0 past the last one.
+  constexpr uint8_t operator[](size_t i) const { return m_groups[i]; }
+
+  constexpr auto operator<=>(const MultisetShape&) const = default;
+
+ private:
+  std::array<uint8_t, K> m_groups{};
+};
+
+template <typename T, size_t K>
+constexpr MultisetShape<K> multiset_shape(std::array<T, K> values) {
+  static_assert(K < 256, "group sizes are stored as uint8_t");
+  sort_network(values);
+
+  std::array<uint8_t, K> sizes{};
+  size_t group = 0;
+  for (size_t i = 0; i < K; i++) {
+    if (i > 0 && values[i] != values[i - 1]) {
+      group++;
+    }
+    sizes[group]++;
+  }
+
+  return MultisetShape<K>(sizes);
+}
+
+// Same for the tuples the tasks return, e.g. std::tuple{c1, c2, c3, c4}.
+template <typename... T>
+constexpr MultisetShape<sizeof...(T)> multiset_shape(
+    const std::tuple<T...>& values) {
+  using Value = std::common_type_t<T...>;
+  return multiset_shape(std::apply(
+      [](const auto&... value) {
+        return std::array<Value, sizeof...(T)>{static_cast<Value>(value)...};
+      },
+      values));
+}
+
+#endif  // !MULTISET_SHAPE_HPP
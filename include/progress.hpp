@@ -0,0 +1,126 @@
+#ifndef PROGRESS_HPP
+#define PROGRESS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <print>
+#include <thread>
+#include <vector>
+
+// Progress bar for a run, drawn by a thread of its own. Workers only bump
+// their own counter with relaxed atomics; the reporter polls the counters at
+// a fixed wall-clock rate and prints the bar with throughput and ETA, so the
+// sampling loops never format, lock or flush. A disabled reporter starts no
+// thread and add() stays a plain store.
+class ProgressReporter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  ProgressReporter(size_t total, unsigned workers, bool enabled,
+                   std::chrono::milliseconds interval =
+                       std::chrono::milliseconds(100))
+      : m_total(std::max<size_t>(total, 1)),
+        m_counters(std::max(workers, 1u)),
+        m_start(Clock::now()) {
+    s_active.fetch_add(1, std::memory_order_relaxed);
+    if (enabled) {
+      m_thread = std::jthread([this, interval](std::stop_token stop) {
+        std::unique_lock lock(m_mutex);
+        auto never = [] { return false; };
+        while (!m_wakeup.wait_for(lock, stop, interval, never) &&
+               !stop.stop_requested()) {
+          print(false);
+        }
+      });
+    }
+  }
+
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+  // Stops the reporter and prints the final state of the bar.
+  ~ProgressReporter() {
+    if (m_thread.joinable()) {
+      m_thread.request_stop();
+      m_thread.join();
+      print(true);
+    }
+    s_finished.fetch_add(done(), std::memory_order_relaxed);
+    s_busy.fetch_add((Clock::now() - m_start).count(),
+                     std::memory_order_relaxed);
+    s_active.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Records n more finished samples for `worker`. Only that worker writes
+  // its counter, so a relaxed load-add-store is enough.
+  void add(unsigned worker, size_t n) {
+    auto& done = m_counters[worker].done;
+    done.store(done.load(std::memory_order_relaxed) + n,
+               std::memory_order_relaxed);
+  }
+
+  size_t done() const {
+    size_t sum = 0;
+    for (const auto& counter : m_counters) {
+      sum += counter.done.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  // Samples counted by every reporter of this process destroyed so far,
+  // and the wall time those reporters were alive, i.e. spent sampling.
+  // task_bench measures the runner through these.
+  static size_t finished() {
+    return s_finished.load(std::memory_order_relaxed);
+  }
+  static double busy_seconds() {
+    return std::chrono::duration<double>(
+               Clock::duration(s_busy.load(std::memory_order_relaxed)))
+        .count();
+  }
+
+  // Whether a run is sampling right now.
+  static bool active() { return s_active.load(std::memory_order_relaxed) > 0; }
+
+ private:
+  // One cache line per worker, so workers never write to a shared line.
+  struct alignas(64) Counter {
+    std::atomic<size_t> done{0};
+  };
+
+  void print(bool final) const {
+    size_t current = std::min(done(), m_total);
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - m_start).count();
+    double rate = seconds > 0.0 ? static_cast<double>(current) / seconds : 0.0;
+    double eta =
+        rate > 0.0 ? static_cast<double>(m_total - current) / rate : 0.0;
+
+    int pos = static_cast<int>(50.0 * static_cast<double>(current) /
+                               static_cast<double>(m_total));
+    std::print("\r[{:=>{}}{:<{}}] {:>3}% {:8.2f}M samples/s ETA {:4.0f}s ", "",
+               pos, "", 50 - pos, 100 * current / m_total, rate / 1e6, eta);
+    if (final) {
+      std::print("\n");
+    }
+    std::fflush(stdout);
+  }
+
+  inline static std::atomic<size_t> s_finished{0};
+  inline static std::atomic<Clock::rep> s_busy{0};
+  inline static std::atomic<int> s_active{0};
+
+  size_t m_total;
+  std::vector<Counter> m_counters;
+  Clock::time_point m_start;
+  std::mutex m_mutex;
+  std::condition_variable_any m_wakeup;
+  std::jthread m_thread;
+};
+
+#endif  // !PROGRESS_HPP
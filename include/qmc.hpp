@@ -0,0 +1,189 @@
+#ifndef QMC_HPP
+#define QMC_HPP
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "engines.hpp"
+
+// Sobol' sequence in up to kMaxDims dimensions with the Joe-Kuo
+// (new-joe-kuo-6.21201) direction numbers and 32 bits per coordinate. With
+// a nonzero seed every coordinate is Owen-scrambled by Burley's hash-based
+// nested uniform scramble, which keeps the net structure while making each
+// point uniform on [0, 1)^dims, so independent seeds give independent
+// randomized replicates. seek() jumps to any index, which lets threads
+// generate disjoint ranges of the same sequence.
+class SobolSequence {
+ public:
+  static constexpr size_t kMaxDims = 16;
+
+  explicit SobolSequence(size_t dims, uint64_t seed = 0)
+      : m_dims(dims), m_scrambled(seed != 0) {
+    // Dimension 0 is the van der Corput sequence in base 2.
+    for (size_t bit = 0; bit < 32; bit++) {
+      m_direction[0][bit] = 1u << (31 - bit);
+    }
+    for (size_t d = 1; d < kMaxDims; d++) {
+      const auto& [degree, poly, m] = kJoeKuo[d - 1];
+      auto& v = m_direction[d];
+      for (size_t bit = 0; bit < degree; bit++) {
+        v[bit] = m[bit] << (31 - bit);
+      }
+      for (size_t bit = degree; bit < 32; bit++) {
+        v[bit] = v[bit - degree] ^ (v[bit - degree] >> degree);
+        for (size_t k = 1; k < degree; k++) {
+          if ((poly >> (degree - 1 - k)) & 1) {
+            v[bit] ^= v[bit - k];
+          }
+        }
+      }
+    }
+
+    uint64_t state = seed;
+    for (auto& scramble : m_scramble) {
+      scramble = static_cast<uint32_t>(splitmix64(state));
+    }
+    seek(0);
+  }
+
+  size_t dims() const { return m_dims; }
+
+  // The next call to next() returns point `index`.
+  void seek(uint64_t index) {
+    m_index = index;
+    uint64_t gray = index ^ (index >> 1);
+    m_state.fill(0);
+    for (size_t bit = 0; gray != 0; bit++, gray >>= 1) {
+      if (gray & 1) {
+        for (size_t d = 0; d < m_dims; d++) {
+          m_state[d] ^= m_direction[d][bit];
+        }
+      }
+    }
+  }
+
+  // Writes the current point to out[0, dims) and moves to the next one.
+  void next(std::span<double> out) {
+    for (size_t d = 0; d < m_dims; d++) {
+      uint32_t x =
+          m_scrambled ? scramble(m_state[d], m_scramble[d]) : m_state[d];
+      out[d] = std::ldexp(static_cast<double>(x), -32);
+    }
+    size_t bit = std::countr_one(m_index);
+    for (size_t d = 0; d < m_dims; d++) {
+      m_state[d] ^= m_direction[d][bit];
+    }
+    m_index++;
+  }
+
+ private:
+  struct Primitive {
+    uint32_t degree;
+    uint32_t poly;
+    std::array<uint32_t, 8> m;
+  };
+
+  // Degree, inner coefficients and initial direction numbers of dimensions
+  // 2..kMaxDims.
+  static constexpr std::array<Primitive, kMaxDims - 1> kJoeKuo = {{
+      {1, 0, {1}},
+      {2, 1, {1, 3}},
+      {3, 1, {1, 3, 1}},
+      {3, 2, {1, 1, 1}},
+      {4, 1, {1, 1, 3, 3}},
+      {4, 4, {1, 3, 5, 13}},
+      {5, 2, {1, 1, 5, 5, 17}},
+      {5, 4, {1, 1, 5, 5, 5}},
+      {5, 7, {1, 1, 7, 11, 19}},
+      {5, 11, {1, 1, 5, 1, 1}},
+      {5, 13, {1, 1, 1, 3, 11}},
+      {5, 14, {1, 3, 5, 5, 31}},
+      {6, 1, {1, 3, 3, 9, 7, 49}},
+      {6, 13, {1, 1, 1, 15, 21, 21}},
+      {6, 16, {1, 3, 1, 13, 27, 49}},
+  }};
+
+  // Nested uniform scramble of the bits of x (Burley 2020): an
+  // ascending-bit permutation applied to the reversed bits.
+  static uint32_t scramble(uint32_t x, uint32_t seed) {
+    x = bit_reverse(x);
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return bit_reverse(x);
+  }
+
+  static uint32_t bit_reverse(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+  }
+
+  size_t m_dims;
+  bool m_scrambled;
+  std::array<std::array<uint32_t, 32>, kMaxDims> m_direction;
+  std::array<uint32_t, kMaxDims> m_state;
+  std::array<uint32_t, kMaxDims> m_scramble;
+  uint64_t m_index = 0;
+};
+
+// Halton sequence: coordinate d is the radical inverse of the index in the
+// d-th prime base. With a nonzero seed every coordinate gets a random
+// Cranley-Patterson shift, which makes each point uniform on [0, 1)^dims
+// so that independent seeds give independent replicates. Points are
+// computed directly from their index, so seek() is free.
+class HaltonSequence {
+ public:
+  static constexpr size_t kMaxDims = 16;
+
+  explicit HaltonSequence(size_t dims, uint64_t seed = 0) : m_dims(dims) {
+    uint64_t state = seed;
+    for (auto& shift : m_shift) {
+      shift = seed == 0
+                  ? 0.0
+                  : std::ldexp(static_cast<double>(splitmix64(state) >> 11),
+                               -53);
+    }
+  }
+
+  size_t dims() const { return m_dims; }
+
+  void seek(uint64_t index) { m_index = index; }
+
+  void next(std::span<double> out) {
+    for (size_t d = 0; d < m_dims; d++) {
+      double x = radical_inverse(m_index, kPrimes[d]) + m_shift[d];
+      out[d] = x >= 1.0 ? x - 1.0 : x;
+    }
+    m_index++;
+  }
+
+ private:
+  static constexpr std::array<uint32_t, kMaxDims> kPrimes = {
+      2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+
+  static double radical_inverse(uint64_t index, uint32_t base) {
+    double inverse_base = 1.0 / base;
+    double scale = inverse_base;
+    double result = 0.0;
+    for (; index != 0; index /= base) {
+      result += static_cast<double>(index % base) * scale;
+      scale *= inverse_base;
+    }
+    return result;
+  }
+
+  size_t m_dims;
+  std::array<double, kMaxDims> m_shift;
+  uint64_t m_index = 0;
+};
+
+#endif  // !QMC_HPP
@@ -0,0 +1,145 @@
+#ifndef RARE_EVENT_HPP
+#define RARE_EVENT_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "sampling.hpp"
+#include "scratch_arena.hpp"
+
+// Importance sampling: draws from a proposal distribution instead of the
+// experiment's own and keeps the likelihood ratio p(x) / q(x) of everything
+// drawn so far. An experiment that returns ratio.weigh(indicator) has the
+// same mean as the plain indicator, so run_until / run_reduce with
+// MeanVariance estimate the original probability; a proposal that makes the
+// event common shrinks the variance by orders of magnitude.
+class LikelihoodRatio {
+ public:
+  // Draws true with probability q in place of p.
+  template <typename RNG>
+  bool bernoulli(RNG& rng, double p, double q) {
+    bool hit = ::bernoulli(rng, q);
+    m_ratio *= hit ? p / q : (1.0 - p) / (1.0 - q);
+    return hit;
+  }
+
+  // Draws an index of [0, n) in place of a uniform one: `favoured` with
+  // probability q, the others uniformly. With n == 1 there is nothing to
+  // choose: the index is 0 and the ratio is unchanged.
+  template <typename RNG>
+  size_t uniform_index(RNG& rng, size_t n, size_t favoured, double q) {
+    if (n <= 1) {
+      return 0;
+    }
+    double uniform = 1.0 / static_cast<double>(n);
+    if (::bernoulli(rng, q)) {
+      m_ratio *= uniform / q;
+      return favoured;
+    }
+    size_t index = ::uniform_index(rng, n - 1);
+    m_ratio *= uniform * static_cast<double>(n - 1) / (1.0 - q);
+    return index < favoured ? index : index + 1;
+  }
+
+  double ratio() const { return m_ratio; }
+
+  // One importance-sampling observation of `value`.
+  double weigh(double value) const { return value * m_ratio; }
+
+ private:
+  double m_ratio = 1.0;
+};
+
+// A trajectory of a splitting run: its state and whether it can still move.
+template <typename State>
+struct SplittingParticle {
+  State state;
+  bool alive;
+};
+
+// fixed_effort_splitting below over two caller-provided buffers of `effort`
+// particles each.
+template <typename RNG, typename Start, typename Advance, typename Level,
+          typename State>
+constexpr double fixed_effort_splitting(
+    RNG& rng, std::span<SplittingParticle<State>> particles,
+    std::span<SplittingParticle<State>> reached, Start&& start,
+    Advance&& advance, Level&& level, std::span<const double> thresholds) {
+  const size_t effort = particles.size();
+  size_t survivors = 0;
+  double estimate = 1.0;
+
+  for (size_t stage = 0; stage < thresholds.size(); stage++) {
+    size_t hits = 0;
+    for (size_t i = 0; i < effort; i++) {
+      SplittingParticle<State> particle =
+          stage == 0 ? SplittingParticle<State>{start(rng), true}
+                     : particles[uniform_index(rng, survivors)];
+      while (particle.alive && level(particle.state) < thresholds[stage]) {
+        particle.alive = advance(particle.state, rng);
+      }
+      if (level(particle.state) >= thresholds[stage]) {
+        reached[hits++] = particle;
+      }
+    }
+
+    estimate *= static_cast<double>(hits) / static_cast<double>(effort);
+    if (hits == 0) {
+      return 0.0;
+    }
+    std::swap(particles, reached);
+    survivors = hits;
+  }
+  return estimate;
+}
+
+// Fixed-effort multilevel splitting for sequential experiments whose event
+// of interest is reaching a far level. start(rng) makes an initial state,
+// advance(state, rng) moves it one step and returns false once the
+// trajectory has ended, and level(state) measures its progress. Each stage
+// runs `effort` trajectories, restarted from states that reached the
+// previous threshold, until they reach the next threshold or end. A
+// trajectory counts by the level it got to, even if the step that got it
+// there also ended it; an ended one is never advanced again. The product of
+// the stage success fractions is an unbiased estimate of P(level reaches
+// thresholds.back()), so the function can serve as the experiment of
+// run_reduce / run_until, one replicate per sample.
+//
+// States are kept in `scratch` and must be trivially destructible.
+template <typename RNG, typename Start, typename Advance, typename Level>
+double fixed_effort_splitting(RNG& rng, ScratchArena& scratch, Start&& start,
+                              Advance&& advance, Level&& level,
+                              std::span<const double> thresholds,
+                              size_t effort) {
+  using State = std::invoke_result_t<Start&, RNG&>;
+  return fixed_effort_splitting(
+      rng, scratch.make<SplittingParticle<State>>(effort),
+      scratch.make<SplittingParticle<State>>(effort), start, advance, level,
+      thresholds);
+}
+
+// A walk that climbs one level per step and ends on reaching level 2: it
+// reaches thresholds 1 and 2, the second with the step that ends it, and,
+// having ended, never reaches 3.
+static_assert([] {
+  struct FirstChoice {
+    constexpr size_t choose(size_t) { return 0; }
+    constexpr bool bernoulli(double) { return true; }
+  } rng;
+  auto start = [](FirstChoice&) { return 0; };
+  auto advance = [](int& level, FirstChoice&) { return ++level < 2; };
+  auto level = [](int state) { return static_cast<double>(state); };
+  std::array<SplittingParticle<int>, 4> a{}, b{};
+  std::span<SplittingParticle<int>> particles(a), reached(b);
+  const std::array<double, 2> reaches{1.0, 2.0};
+  const std::array<double, 3> beyond{1.0, 2.0, 3.0};
+  return fixed_effort_splitting(rng, particles, reached, start, advance,
+                                level, reaches) == 1.0 &&
+         fixed_effort_splitting(rng, particles, reached, start, advance,
+                                level, beyond) == 0.0;
+}());
+
+#endif  // !RARE_EVENT_HPP
@@ -0,0 +1,192 @@
+#ifndef REDUCERS_HPP
+#define REDUCERS_HPP
+
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "tally.hpp"
+
+// A reducer folds experiment results one at a time and can absorb another
+// reducer of the same type that folded a disjoint range of results.
+template <typename R, typename T>
+concept Reducer = std::copy_constructible<R> &&
+                  requires(R reducer, const R& other, const T& value) {
+                    reducer.add(value);
+                    reducer.merge(other);
+                  };
+
+// Counts results that convert to true.
+class Count {
+ public:
+  template <typename T>
+  void add(const T& value) {
+    m_hits += static_cast<bool>(value);
+    m_total++;
+  }
+
+  void merge(const Count& other) {
+    m_hits += other.m_hits;
+    m_total += other.m_total;
+  }
+
+  template <typename Writer>
+  void save(Writer& out) const {
+    out.write(m_hits);
+    out.write(m_total);
+  }
+
+  template <typename Reader>
+  void load(Reader& in) {
+    in.read(m_hits);
+    in.read(m_total);
+  }
+
+  size_t hits() const { return m_hits; }
+  size_t total() const { return m_total; }
+
+  double probability() const {
+    return m_total == 0 ? 0.0
+                        : static_cast<double>(m_hits) /
+                              static_cast<double>(m_total);
+  }
+
+ private:
+  size_t m_hits = 0;
+  size_t m_total = 0;
+};
+
+// Counts, in one pass, the results satisfying each of a fixed set of
+// predicates, for experiments whose outcome only matters through a few
+// events. The predicates are part of the type, so run_reduce compiles the
+// sampling, the tests and the counting into one loop with no results
+// stored. Build with events(pred...).
+template <typename... Preds>
+class Events {
+ public:
+  static constexpr size_t kEvents = sizeof...(Preds);
+
+  explicit Events(Preds... preds) : m_preds(std::move(preds)...) {}
+
+  template <typename T>
+  void add(const T& value) {
+    add(value, std::index_sequence_for<Preds...>{});
+  }
+
+  void merge(const Events& other) {
+    for (size_t i = 0; i < kEvents; i++) {
+      m_hits[i] += other.m_hits[i];
+    }
+    m_total += other.m_total;
+  }
+
+  template <typename Writer>
+  void save(Writer& out) const {
+    out.write(m_hits);
+    out.write(m_total);
+  }
+
+  template <typename Reader>
+  void load(Reader& in) {
+    in.read(m_hits);
+    in.read(m_total);
+  }
+
+  // Results satisfying the i-th predicate.
+  size_t hits(size_t i) const { return m_hits[i]; }
+  size_t total() const { return m_total; }
+
+  double probability(size_t i) const {
+    return m_total == 0 ? 0.0
+                        : static_cast<double>(m_hits[i]) /
+                              static_cast<double>(m_total);
+  }
+
+ private:
+  template <typename T, size_t... I>
+  void add(const T& value, std::index_sequence<I...>) {
+    ((m_hits[I] += static_cast<bool>(std::get<I>(m_preds)(value))), ...);
+    m_total++;
+  }
+
+  std::tuple<Preds...> m_preds;
+  std::array<size_t, kEvents> m_hits{};
+  size_t m_total = 0;
+};
+
+template <typename... Preds>
+Events<std::decay_t<Preds>...> events(Preds&&... preds) {
+  return Events<std::decay_t<Preds>...>(std::forward<Preds>(preds)...);
+}
+
+// Number of occurrences of every distinct result; see tally.hpp.
+template <typename T>
+using Histogram = Tally<T>;
+
+// Running mean and variance (Welford), merged with Chan's pairwise update.
+class MeanVariance {
+ public:
+  template <typename T>
+  void add(const T& value) {
+    double x = static_cast<double>(value);
+    m_count++;
+    double delta = x - m_mean;
+    m_mean += delta / static_cast<double>(m_count);
+    m_m2 += delta * (x - m_mean);
+  }
+
+  void merge(const MeanVariance& other) {
+    if (other.m_count == 0) {
+      return;
+    }
+    if (m_count == 0) {
+      *this = other;
+      return;
+    }
+    double n_a = static_cast<double>(m_count);
+    double n_b = static_cast<double>(other.m_count);
+    double n = n_a + n_b;
+    double delta = other.m_mean - m_mean;
+    m_mean += delta * n_b / n;
+    m_m2 += other.m_m2 + delta * delta * n_a * n_b / n;
+    m_count += other.m_count;
+  }
+
+  template <typename Writer>
+  void save(Writer& out) const {
+    out.write(m_count);
+    out.write(m_mean);
+    out.write(m_m2);
+  }
+
+  template <typename Reader>
+  void load(Reader& in) {
+    in.read(m_count);
+    in.read(m_mean);
+    in.read(m_m2);
+  }
+
+  size_t count() const { return m_count; }
+  double mean() const { return m_mean; }
+
+  double variance() const {
+    return m_count < 2 ? 0.0 : m_m2 / static_cast<double>(m_count - 1);
+  }
+
+  double std_error() const {
+    return m_count == 0
+               ? 0.0
+               : std::sqrt(variance() / static_cast<double>(m_count));
+  }
+
+ private:
+  size_t m_count = 0;
+  double m_mean = 0.0;
+  double m_m2 = 0.0;
+};
+
+#endif  // !REDUCERS_HPP
@@ -0,0 +1,122 @@
+#ifndef SAMPLING_HPP
+#define SAMPLING_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <utility>
+
+// Engines that pick one of n equally likely branches themselves instead of
+// producing random bits, such as ChoiceEnumerator. Experiments drawing
+// through the helpers below run unchanged on them.
+template <typename RNG>
+concept ChoiceEngine = requires(RNG& rng, size_t n, double p) {
+  { rng.choose(n) } -> std::same_as<size_t>;
+  { rng.bernoulli(p) } -> std::same_as<bool>;
+};
+
+// Uniform index in [0, n).
+template <typename RNG>
+constexpr size_t uniform_index(RNG& rng, size_t n) {
+  if constexpr (ChoiceEngine<RNG>) {
+    return rng.choose(n);
+  } else {
+    return std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+  }
+}
+
+// Uniform integer in [a, b].
+template <std::integral T, typename RNG>
+T uniform_int(RNG& rng, T a, T b) {
+  return static_cast<T>(a + uniform_index(rng, static_cast<size_t>(b - a) + 1));
+}
+
+// true with probability p.
+template <typename RNG>
+bool bernoulli(RNG& rng, double p) {
+  if constexpr (ChoiceEngine<RNG>) {
+    return rng.bernoulli(p);
+  } else {
+    return std::bernoulli_distribution(p)(rng);
+  }
+}
+
+// Rearranges items so that its first k elements are distributed like the
+// first k of a full std::shuffle, in order, using k swaps instead of
+// items.size(). Returns those k elements. For drawing k of a list of
+// values where the order of the draws matters; floyd_sample does the same
+// for indices without a list.
+template <typename T, typename RNG>
+constexpr std::span<T> partial_shuffle(std::span<T> items, size_t k,
+                                       RNG& rng) {
+  for (size_t i = 0; i < k; i++) {
+    std::swap(items[i], items[i + uniform_index(rng, items.size() - i)]);
+  }
+  return items.first(k);
+}
+
+// Fills out with out.size() distinct indices from [0, n) in random order,
+// i.e. the first out.size() positions of a random permutation of [0, n),
+// without building the permutation. Floyd's algorithm in its ordered form:
+// one uniform draw per index and O(k^2) comparisons for k = out.size(), so
+// it is meant for the small hands drawn from decks and urns.
+template <typename RNG>
+std::span<size_t> floyd_sample(size_t n, std::span<size_t> out, RNG& rng) {
+  size_t size = 0;
+  for (size_t j = n - out.size(); j < n; j++) {
+    size_t t = uniform_index(rng, j + 1);
+    auto end = out.begin() + size;
+    auto found = std::find(out.begin(), end, t);
+    if (found == end) {
+      std::shift_right(out.begin(), end + 1, 1);
+      out[0] = t;
+    } else {
+      std::shift_right(found + 1, end + 1, 1);
+      *(found + 1) = j;
+    }
+    size++;
+  }
+  return out;
+}
+
+// floyd_sample for a hand size known at compile time:
+//   auto [first, second] = floyd_sample<2>(100, rng);
+template <size_t K, typename RNG>
+std::array<size_t, K> floyd_sample(size_t n, RNG& rng) {
+  std::array<size_t, K> out;
+  floyd_sample(n, std::span<size_t>(out), rng);
+  return out;
+}
+
+// Number of successes among `draws` items taken without replacement from a
+// population holding `successes` of them. Draws the items one at a time
+// instead of materialising the population.
+template <typename RNG>
+size_t hypergeometric(size_t population, size_t successes, size_t draws,
+                      RNG& rng) {
+  size_t hits = 0;
+  for (size_t i = 0; i < draws && hits < successes; i++) {
+    if (uniform_index(rng, population - i) < successes - hits) {
+      hits++;
+    }
+  }
+  return hits;
+}
+
+// Swap i of partial_shuffle exchanges item i with item i + choose(n - i):
+// here always the last one, so [0, 1, 2, 3, 4] gives 4, then 0.
+static_assert([] {
+  struct LastChoice {
+    constexpr size_t choose(size_t n) { return n - 1; }
+    constexpr bool bernoulli(double) { return true; }
+  } rng;
+  std::array<int, 5> items{0, 1, 2, 3, 4};
+  auto head = partial_shuffle(std::span<int>(items), 2, rng);
+  return head.size() == 2 && head[0] == 4 && head[1] == 0 &&
+         items == std::array<int, 5>{4, 0, 2, 3, 1};
+}());
+
+#endif  // !SAMPLING_HPP
@@ -0,0 +1,77 @@
+#ifndef SCRATCH_ARENA_HPP
+#define SCRATCH_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for the temporaries of one experiment whose size is only
+// known at run time, such as the permutations of 121 and 122 or the states
+// of a splitting run. Hands of a fixed size are better drawn with
+// floyd_sample (see sampling.hpp), which needs no buffer at all. TaskRunner
+// gives every worker its own arena and resets it after each sample, so a
+// sample asking for the same buffers as the previous one gets the same
+// memory back and, once the arena has grown to the high-water mark, no
+// sample touches the heap.
+class ScratchArena {
+ public:
+  // `count` value-initialised objects, valid until the next reset().
+  template <typename T>
+  std::span<T> make(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena memory is reused without running destructors");
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+
+    T* data = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    std::uninitialized_value_construct_n(data, count);
+    return {data, count};
+  }
+
+  // `count` copies of `value`, valid until the next reset().
+  template <typename T>
+  std::span<T> make(size_t count, const T& value) {
+    auto span = make<T>(count);
+    std::ranges::fill(span, value);
+    return span;
+  }
+
+  // Releases everything handed out since the last reset. If a sample needed
+  // more than the main buffer, the buffer is regrown once to fit it.
+  void reset() {
+    if (!m_overflow.empty()) {
+      m_capacity = m_high_water;
+      m_buffer = std::make_unique_for_overwrite<std::byte[]>(m_capacity);
+      m_overflow.clear();
+    }
+    m_used = 0;
+    m_requested = 0;
+  }
+
+ private:
+  void* allocate(size_t bytes, size_t alignment) {
+    size_t offset = (m_used + alignment - 1) / alignment * alignment;
+    m_requested += bytes + alignment;
+    m_high_water = std::max(m_high_water, m_requested);
+
+    if (offset + bytes <= m_capacity) {
+      m_used = offset + bytes;
+      return m_buffer.get() + offset;
+    }
+    m_overflow.push_back(std::make_unique_for_overwrite<std::byte[]>(
+        std::max<size_t>(bytes, 1)));
+    return m_overflow.back().get();
+  }
+
+  std::unique_ptr<std::byte[]> m_buffer;
+  size_t m_capacity = 0;
+  size_t m_used = 0;
+  // Bytes requested since the last reset, including worst-case padding.
+  size_t m_requested = 0;
+  size_t m_high_water = 0;
+  std::vector<std::unique_ptr<std::byte[]>> m_overflow;
+};
+
+#endif  // !SCRATCH_ARENA_HPP
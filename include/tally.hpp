@@ -0,0 +1,325 @@
+#ifndef TALLY_HPP
+#define TALLY_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Outcomes whose whole domain fits a small array known at compile time.
+template <typename T>
+concept SmallDomain =
+    std::same_as<T, bool> ||
+    ((std::integral<T> || std::is_enum_v<T>) && sizeof(T) == 1);
+
+// Wider integers and enums: usually a handful of nearby values at runtime.
+template <typename T>
+concept IntegralDomain =
+    !SmallDomain<T> && (std::integral<T> || std::is_enum_v<T>);
+
+template <typename T>
+concept Hashable = requires(const T& value) {
+  { std::hash<T>{}(value) } -> std::convertible_to<size_t>;
+};
+
+// Counts occurrences of every distinct outcome. The storage is picked from
+// the outcome type: a flat array for bool and byte-sized types, a growable
+// dense window for other integers and enums, and a hash map (or std::map for
+// unhashable types) for everything else.
+template <typename T>
+class Tally {
+ public:
+  void add(const T& value) {
+    m_counts[value]++;
+    m_total++;
+  }
+
+  // Adds `count` occurrences of value at once.
+  void add(const T& value, size_t count) {
+    m_counts[value] += count;
+    m_total += count;
+  }
+
+  void merge(const Tally& other) {
+    for (const auto& [value, count] : other.m_counts) {
+      m_counts[value] += count;
+    }
+    m_total += other.m_total;
+  }
+
+  size_t operator[](const T& value) const {
+    auto it = m_counts.find(value);
+    return it == m_counts.end() ? 0 : it->second;
+  }
+
+  size_t total() const { return m_total; }
+
+  // Distinct outcomes with their counts, in ascending order when T has one.
+  std::vector<std::pair<T, size_t>> entries() const {
+    std::vector<std::pair<T, size_t>> result(m_counts.begin(),
+                                             m_counts.end());
+    if constexpr (std::totally_ordered<T>) {
+      std::ranges::sort(result, {}, &std::pair<T, size_t>::first);
+    }
+    return result;
+  }
+
+  // Checkpoint support (see checkpoint.hpp). Outcomes are stored in their
+  // in-memory representation, so a tally of any other T is not
+  // Checkpointable.
+  template <typename Writer>
+    requires std::is_trivially_copyable_v<T>
+  void save(Writer& out) const {
+    out.write_entries(entries());
+  }
+
+  template <typename Reader>
+    requires std::is_trivially_copyable_v<T>
+  void load(Reader& in) {
+    *this = Tally();
+    for (const auto& [value, count] : in.template read_entries<T>()) {
+      add(value, count);
+    }
+  }
+
+ private:
+  using Storage =
+      std::conditional_t<Hashable<T>, std::unordered_map<T, size_t>,
+                         std::map<T, size_t>>;
+
+  Storage m_counts;
+  size_t m_total = 0;
+};
+
+template <SmallDomain T>
+class Tally<T> {
+ public:
+  void add(const T& value) {
+    m_counts[index(value)]++;
+    m_total++;
+  }
+
+  void add(const T& value, size_t count) {
+    m_counts[index(value)] += count;
+    m_total += count;
+  }
+
+  // Bulk add used by batch kernels; for bool it is one vectorised count.
+  void add_all(std::span<const T> values) {
+    if constexpr (std::same_as<T, bool>) {
+      size_t hits = std::ranges::count(values, true);
+      m_counts[1] += hits;
+      m_counts[0] += values.size() - hits;
+    } else {
+      for (const T& value : values) {
+        m_counts[index(value)]++;
+      }
+    }
+    m_total += values.size();
+  }
+
+  void merge(const Tally& other) {
+    for (size_t i = 0; i < kSize; i++) {
+      m_counts[i] += other.m_counts[i];
+    }
+    m_total += other.m_total;
+  }
+
+  size_t operator[](const T& value) const { return m_counts[index(value)]; }
+
+  size_t total() const { return m_total; }
+
+  std::vector<std::pair<T, size_t>> entries() const {
+    std::vector<std::pair<T, size_t>> result;
+    for (size_t i = 0; i < kSize; i++) {
+      if (m_counts[i] != 0) {
+        result.emplace_back(static_cast<T>(i), m_counts[i]);
+      }
+    }
+    std::ranges::sort(result, {}, &std::pair<T, size_t>::first);
+    return result;
+  }
+
+  // Checkpoint support (see checkpoint.hpp).
+  template <typename Writer>
+  void save(Writer& out) const {
+    out.write_entries(entries());
+  }
+
+  template <typename Reader>
+  void load(Reader& in) {
+    *this = Tally();
+    for (const auto& [value, count] : in.template read_entries<T>()) {
+      add(value, count);
+    }
+  }
+
+ private:
+  static constexpr size_t kSize = std::same_as<T, bool> ? 2 : 256;
+
+  static size_t index(const T& value) {
+    return static_cast<uint8_t>(value);
+  }
+
+  std::array<size_t, kSize> m_counts{};
+  size_t m_total = 0;
+};
+
+template <IntegralDomain T>
+class Tally<T> {
+ public:
+  // Widest value range kept as a flat array before switching to a hash map.
+  static constexpr uint64_t kMaxDenseSpan = 1 << 16;
+
+  void add(const T& value) {
+    uint64_t key = to_key(value);
+    uint64_t offset = key - m_low;
+    if (offset < m_dense.size()) [[likely]] {
+      m_dense[offset]++;
+    } else {
+      add_slow(key, 1);
+    }
+    m_total++;
+  }
+
+  void add(const T& value, size_t count) {
+    add_key(to_key(value), count);
+    m_total += count;
+  }
+
+  void merge(const Tally& other) {
+    for (size_t i = 0; i < other.m_dense.size(); i++) {
+      if (other.m_dense[i] != 0) {
+        add_key(other.m_low + i, other.m_dense[i]);
+      }
+    }
+    for (const auto& [key, count] : other.m_sparse) {
+      add_key(key, count);
+    }
+    m_total += other.m_total;
+  }
+
+  size_t operator[](const T& value) const {
+    uint64_t key = to_key(value);
+    uint64_t offset = key - m_low;
+    if (offset < m_dense.size()) {
+      return m_dense[offset];
+    }
+    auto it = m_sparse.find(key);
+    return it == m_sparse.end() ? 0 : it->second;
+  }
+
+  size_t total() const { return m_total; }
+
+  std::vector<std::pair<T, size_t>> entries() const {
+    std::vector<std::pair<T, size_t>> result;
+    for (size_t i = 0; i < m_dense.size(); i++) {
+      if (m_dense[i] != 0) {
+        result.emplace_back(from_key(m_low + i), m_dense[i]);
+      }
+    }
+    for (const auto& [key, count] : m_sparse) {
+      result.emplace_back(from_key(key), count);
+    }
+    std::ranges::sort(result, {}, &std::pair<T, size_t>::first);
+    return result;
+  }
+
+  // Checkpoint support (see checkpoint.hpp).
+  template <typename Writer>
+  void save(Writer& out) const {
+    out.write_entries(entries());
+  }
+
+  template <typename Reader>
+  void load(Reader& in) {
+    *this = Tally();
+    for (const auto& [value, count] : in.template read_entries<T>()) {
+      add(value, count);
+    }
+  }
+
+ private:
+  using Underlying =
+      typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>,
+                                  std::type_identity<T>>::type;
+
+  // Maps values to unsigned keys in an order-preserving way, so the dense
+  // window is a contiguous key range for signed and unsigned types alike.
+  static uint64_t to_key(const T& value) {
+    auto raw = static_cast<Underlying>(value);
+    if constexpr (std::is_signed_v<Underlying>) {
+      return static_cast<uint64_t>(static_cast<int64_t>(raw)) ^
+             (uint64_t{1} << 63);
+    } else {
+      return static_cast<uint64_t>(raw);
+    }
+  }
+
+  static T from_key(uint64_t key) {
+    if constexpr (std::is_signed_v<Underlying>) {
+      auto raw = static_cast<int64_t>(key ^ (uint64_t{1} << 63));
+      return static_cast<T>(static_cast<Underlying>(raw));
+    } else {
+      return static_cast<T>(static_cast<Underlying>(key));
+    }
+  }
+
+  void add_key(uint64_t key, size_t count) {
+    uint64_t offset = key - m_low;
+    if (offset < m_dense.size()) {
+      m_dense[offset] += count;
+    } else {
+      add_slow(key, count);
+    }
+  }
+
+  // Widens the dense window to cover `key`, or spills to the hash map once
+  // the window would grow past kMaxDenseSpan.
+  void add_slow(uint64_t key, size_t count) {
+    if (m_dense.empty() && m_sparse.empty()) {
+      m_low = key;
+      m_dense.assign(1, count);
+      return;
+    }
+    if (!m_sparse.empty()) {
+      m_sparse[key] += count;
+      return;
+    }
+
+    uint64_t high = m_low + m_dense.size() - 1;
+    uint64_t new_low = std::min(m_low, key);
+    uint64_t new_high = std::max(high, key);
+    if (new_high - new_low >= kMaxDenseSpan) {
+      for (size_t i = 0; i < m_dense.size(); i++) {
+        if (m_dense[i] != 0) {
+          m_sparse[m_low + i] += m_dense[i];
+        }
+      }
+      m_dense.clear();
+      m_sparse[key] += count;
+      return;
+    }
+
+    std::vector<size_t> grown(new_high - new_low + 1, 0);
+    std::ranges::copy(m_dense, grown.begin() + (m_low - new_low));
+    grown[key - new_low] += count;
+    m_dense = std::move(grown);
+    m_low = new_low;
+  }
+
+  uint64_t m_low = 0;
+  std::vector<size_t> m_dense;
+  std::unordered_map<uint64_t, size_t> m_sparse;
+  size_t m_total = 0;
+};
+
+#endif  // !TALLY_HPP
@@ -1,57 +1,893 @@
 #ifndef TASK_RUNNER_HPP
 #define TASK_RUNNER_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <print>
 #include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include "checkpoint.hpp"
+#include "column_export.hpp"
+#include "distributed.hpp"
+#include "engines.hpp"
+#include "enumerate.hpp"
+#include "estimate.hpp"
+#include "multiset_shape.hpp"
+#include "progress.hpp"
+#include "qmc.hpp"
+#include "rare_event.hpp"
+#include "reducers.hpp"
+#include "sampling.hpp"
+#include "scratch_arena.hpp"
+#include "tally.hpp"
+#include "threshold.hpp"
+#include "uniform_batch.hpp"
+#include "variance_reduction.hpp"
+
+// An experiment draws from the engine and returns one outcome. It may also
+// take the worker's ScratchArena for temporaries it would otherwise allocate
+// on every call.
+template <typename E, typename RNG>
+concept Experiment = std::uniform_random_bit_generator<RNG> &&
+                     (std::invocable<E, RNG&> ||
+                      std::invocable<E, RNG&, ScratchArena&>);
+
 template <typename E, typename RNG>
-concept Experiment =
-    std::uniform_random_bit_generator<RNG> && std::invocable<E, RNG&>;
+using experiment_result_t =
+    typename std::conditional_t<std::invocable<E, RNG&, ScratchArena&>,
+                                std::invoke_result<E, RNG&, ScratchArena&>,
+                                std::invoke_result<E, RNG&>>::type;
+
+// Engines whose position can be set directly (see Philox4x32). The runner
+// moves them to a substream of their own for every sample, so a single
+// experiment can be reproduced without replaying the ones before it.
+template <typename RNG>
+concept CounterBasedEngine = requires(RNG rng, uint64_t stream) {
+  rng.seek(stream);
+};
+
+// Number of means a QMC kernel yields per point: a kernel returning
+// std::array<T, N> estimates N quantities from the same points.
+template <typename T>
+inline constexpr size_t kQmcOutputs = 1;
+
+template <typename T, size_t N>
+inline constexpr size_t kQmcOutputs<std::array<T, N>> = N;
+
+// Builds the engine for one block of simulations. Every block gets its own
+// stream derived from the master seed, so the output of a run depends only on
+// the seed and not on how many threads happened to execute it. Engines with a
+// (seed, stream) constructor use their native substreams; the standard ones
+// are seeded through std::seed_seq.
+template <std::uniform_random_bit_generator RNG>
+RNG make_stream(uint64_t seed, uint64_t stream) {
+  if constexpr (std::constructible_from<RNG, uint64_t, uint64_t>) {
+    return RNG(seed, stream);
+  } else {
+    std::seed_seq seq{static_cast<uint32_t>(seed),
+                      static_cast<uint32_t>(seed >> 32),
+                      static_cast<uint32_t>(stream),
+                      static_cast<uint32_t>(stream >> 32)};
+    return RNG(seq);
+  }
+}
 
-template <std::uniform_random_bit_generator RNG = std::mt19937>
+// Runs experiments on a pool of threads. The engine defaults to
+// xoshiro256++, which is several times faster than std::mt19937 and keeps
+// 32 bytes of state per block stream instead of 2.5 KB; any standard engine
+// can still be chosen, e.g. TaskRunner<std::mt19937>.
+template <std::uniform_random_bit_generator RNG = Xoshiro256pp>
 class TaskRunner {
  public:
+  // Simulations are split into blocks of this size; a block is the unit of
+  // scheduling and of RNG stream assignment.
+  static constexpr size_t kBlockSize = 1 << 16;
+
+  // Blocks per thread that an exporting run_reduce may run ahead of the
+  // oldest block not yet written to its file.
+  static constexpr size_t kExportWindow = 2;
+
+  // Samples generated and evaluated together by run_uniform.
+  static constexpr size_t kBatchSize = 256;
+  static_assert(kBlockSize % kBatchSize == 0 &&
+                kBatchSize % UniformBatchEngine::kLanes == 0);
+
+  TaskRunner() : TaskRunner(random_seed()) {}
+
+  explicit TaskRunner(uint64_t seed, unsigned threads = default_threads())
+      : m_seed(seed), m_threads(std::max(threads, 1u)) {}
+
+  // Threads of a runner not given a count: TASK_THREADS from the
+  // environment when it holds a positive number, one per hardware thread
+  // otherwise.
+  static unsigned default_threads() {
+    if (const char* env = std::getenv("TASK_THREADS")) {
+      std::string_view text(env);
+      unsigned threads = 0;
+      auto [end, error] =
+          std::from_chars(text.data(), text.data() + text.size(), threads);
+      if (error == std::errc{} && end == text.data() + text.size() &&
+          threads > 0) {
+        return threads;
+      }
+    }
+    return std::thread::hardware_concurrency();
+  }
+
+  uint64_t seed() const { return m_seed; }
+  unsigned threads() const { return m_threads; }
+
+  // Every result, in simulation order. Each block fills a vector of its
+  // own, so the result type need not be default-constructible and workers
+  // never write to shared storage (std::vector<bool> packs neighbours into
+  // one word); the blocks are concatenated once all have run.
   template <Experiment<RNG> E>
   auto run(E&& experiment, size_t simulations, bool show_progress = true) {
-    using result_type = std::invoke_result_t<E, RNG&>;
+    using result_type = experiment_result_t<E, RNG>;
+
+    std::vector<std::vector<result_type>> blocks(block_count(simulations));
+
+    for_each_block(simulations, show_progress,
+                   [&](size_t block, size_t begin, size_t end, RNG& rng,
+                       ScratchArena& scratch) {
+                     std::decay_t<E> local(experiment);
+                     auto& chunk = blocks[block];
+                     chunk.reserve(end - begin);
+                     for (size_t i = begin; i < end; i++) {
+                       chunk.push_back(invoke_sample(local, rng, scratch, i));
+                     }
+                   });
 
     std::vector<result_type> results;
     results.reserve(simulations);
+    for (auto& chunk : blocks) {
+      results.insert(results.end(), std::make_move_iterator(chunk.begin()),
+                     std::make_move_iterator(chunk.end()));
+      chunk = {};
+    }
+    return results;
+  }
+
+  // Folds results into `reducer` as they are produced instead of storing
+  // them, so memory stays at the size of the reducer however many simulations
+  // run. `reducer` is the empty prototype every block starts from; block
+  // partials are merged in block order to keep floating-point sums
+  // reproducible.
+  template <Experiment<RNG> E, Reducer<experiment_result_t<E, RNG>> R>
+  R run_reduce(E&& experiment, size_t simulations, R reducer,
+               bool show_progress = true) {
+    R total = reducer;
+    BlockMerger<R> merger(total);
 
-    RNG rng(std::random_device{}());
+    for_each_block(simulations, show_progress,
+                   [&](size_t block, size_t begin, size_t end, RNG& rng,
+                       ScratchArena& scratch) {
+                     std::decay_t<E> local(experiment);
+                     R partial = reducer;
+                     for (size_t i = begin; i < end; i++) {
+                       partial.add(invoke_sample(local, rng, scratch, i));
+                     }
+                     merger.submit(block, std::move(partial));
+                   });
+
+    return total;
+  }
+
+  // run_reduce that survives being killed: the reducer of the blocks merged
+  // so far is saved to checkpoint.path at most every checkpoint.interval,
+  // and a run that finds a checkpoint of the same run resumes after its
+  // last block, with the seed that run was started with. The checkpoint
+  // carries a fingerprint of the experiment, reducer and engine types, the
+  // executable and checkpoint.tag; one left by anything else is ignored.
+  // Blocks merge in the same order either way, so the result is
+  // bit-identical to an uninterrupted run. The checkpoint is removed when
+  // the run completes.
+  template <Experiment<RNG> E, Reducer<experiment_result_t<E, RNG>> R>
+    requires Checkpointable<R>
+  R run_reduce(E&& experiment, size_t simulations, R reducer,
+               const Checkpoint& checkpoint, bool show_progress = true) {
+    const size_t blocks = block_count(simulations);
+    const uint64_t fingerprint =
+        checkpoint_fingerprint<std::decay_t<E>, R, RNG>(checkpoint.tag);
+
+    R saved = reducer;
+    uint64_t seed = m_seed;
+    size_t first = 0;
+    auto header = load_checkpoint(checkpoint.path, fingerprint, saved);
+    bool resume = header && header->fingerprint == fingerprint &&
+                  header->simulations == simulations &&
+                  header->block_size == kBlockSize &&
+                  header->next_block <= blocks;
+    if (resume) {
+      seed = header->seed;
+      first = header->next_block;
+    } else if (header) {
+      std::print(stderr, "Ignoring checkpoint {} of a different run\n",
+                 checkpoint.path);
+    }
+    R total = resume ? saved : reducer;
+
+    // Snapshots of the total are taken under the merger's lock but written
+    // by the worker that took them after it lets go, so the others keep
+    // merging during the write. A snapshot older than the file is dropped.
+    std::mutex snapshot_mutex;
+    std::optional<std::pair<size_t, R>> snapshot;
+    std::mutex file_mutex;
+    size_t saved_block = first;
+    bool save_failed = false;
+
+    BlockMerger<R> merger(total, first);
+    auto last_save = std::chrono::steady_clock::now();
+    merger.on_advance([&](size_t next_block, const R& merged) {
+      auto now = std::chrono::steady_clock::now();
+      if (now - last_save >= checkpoint.interval && next_block < blocks) {
+        std::lock_guard lock(snapshot_mutex);
+        snapshot.emplace(next_block, merged);
+        last_save = now;
+      }
+    });
 
-    for (size_t i = 0; i < simulations; i++) {
-      results.push_back(std::forward<E>(experiment)(rng));
-      if (show_progress && i % 1000 == 0) {
-        print_progress(i, simulations);
+    auto save_snapshot = [&] {
+      std::optional<std::pair<size_t, R>> taken;
+      {
+        std::lock_guard lock(snapshot_mutex);
+        taken.swap(snapshot);
       }
+      if (!taken) {
+        return;
+      }
+      std::lock_guard lock(file_mutex);
+      if (taken->first <= saved_block) {
+        return;
+      }
+      CheckpointHeader position{seed, fingerprint, simulations, kBlockSize,
+                                taken->first};
+      if (save_checkpoint(checkpoint.path, position, taken->second)) {
+        saved_block = taken->first;
+      } else if (!save_failed) {
+        save_failed = true;
+        std::print(stderr, "Cannot save checkpoint {}, continuing without\n",
+                   checkpoint.path);
+      }
+    };
+
+    ProgressReporter progress(simulations - std::min(simulations,
+                                                     first * kBlockSize),
+                              m_threads, show_progress);
+    for_each_block(seed, first, blocks, simulations, progress,
+                   [&](size_t block, size_t begin, size_t end, RNG& rng,
+                       ScratchArena& scratch) {
+                     std::decay_t<E> local(experiment);
+                     R partial = reducer;
+                     for (size_t i = begin; i < end; i++) {
+                       partial.add(invoke_sample(local, rng, scratch, i));
+                     }
+                     merger.submit(block, std::move(partial));
+                     save_snapshot();
+                   });
+
+    std::remove(checkpoint.path.c_str());
+    return total;
+  }
+
+  // run_reduce that also streams every sample's outcome to a column file
+  // (see column_export.hpp) for analysis without re-simulating. Each block
+  // buffers its outcomes column by column and the blocks are appended as
+  // row groups in block order, so the file does not depend on the thread
+  // count. A block more than kExportWindow blocks per thread past the
+  // oldest unwritten one waits before it runs, which bounds the buffers
+  // held while a slow block holds up the file. The other run_reduce
+  // overloads never touch any of this.
+  template <Experiment<RNG> E, Reducer<experiment_result_t<E, RNG>> R>
+    requires Exportable<experiment_result_t<E, RNG>>
+  R run_reduce(E&& experiment, size_t simulations, R reducer,
+               const ResultExport& sink, bool show_progress = true) {
+    using result_type = experiment_result_t<E, RNG>;
+
+    ColumnFile<result_type> file(sink);
+    BlockMerger<ColumnBatch<result_type>, ColumnFile<result_type>> writer(
+        file);
+    R total = reducer;
+    BlockMerger<R> merger(total);
+
+    for_each_block(simulations, show_progress,
+                   [&](size_t block, size_t begin, size_t end, RNG& rng,
+                       ScratchArena& scratch) {
+                     writer.wait_for_room(block, kExportWindow * m_threads);
+                     std::decay_t<E> local(experiment);
+                     R partial = reducer;
+                     ColumnBatch<result_type> batch;
+                     batch.reserve(end - begin);
+                     for (size_t i = begin; i < end; i++) {
+                       auto result = invoke_sample(local, rng, scratch, i);
+                       batch.add(result);
+                       partial.add(std::move(result));
+                     }
+                     merger.submit(block, std::move(partial));
+                     writer.submit(block, std::move(batch));
+                   });
+
+    if (!file.flush()) {
+      throw std::runtime_error("cannot write " + sink.path);
     }
+    return total;
+  }
+
+  // run_reduce over worker processes instead of threads. The workers are
+  // forked copies of this process that run ranges of blocks, each block
+  // with its own stream as in the threaded run, and send every block's
+  // reducer back in checkpoint format; the coordinator merges them in block
+  // order, so the result is the same as run_reduce with the same seed.
+  // Blocks a crashed worker, or one killed for exceeding
+  // processes.reply_timeout, did not deliver are rerun by the others; throws
+  // std::runtime_error only when every worker has died.
+  template <Experiment<RNG> E, Reducer<experiment_result_t<E, RNG>> R>
+    requires Checkpointable<R>
+  R run_reduce(E&& experiment, size_t simulations, R reducer,
+               const Processes& processes, bool show_progress = true) {
+    const size_t blocks = block_count(simulations);
+    const unsigned count = static_cast<unsigned>(
+        std::clamp<size_t>(blocks, 1, std::max(processes.count, 1u)));
+
+    WorkerPool pool(count, [&](int fd) {
+      ScratchArena scratch;
+      serve_blocks(fd, [&](size_t block, CheckpointWriter& out) {
+        size_t begin = block * kBlockSize;
+        size_t end = std::min(begin + kBlockSize, simulations);
+
+        RNG rng = make_stream<RNG>(m_seed, block);
+        std::decay_t<E> local(experiment);
+        R partial = reducer;
+        for (size_t i = begin; i < end; i++) {
+          partial.add(invoke_sample(local, rng, scratch, i));
+        }
+        partial.save(out);
+      });
+    });
 
-    if (show_progress) {
-      std::print("\r[{:=>50}] {:>3}%\n", "", 100);
+    R total = reducer;
+    BlockMerger<R> merger(total);
+    ProgressReporter progress(simulations, pool.size(), show_progress);
+
+    bool complete = pool.distribute(
+        blocks, processes.blocks_per_task, processes.reply_timeout,
+        [&](unsigned worker, size_t block, CheckpointReader& in) {
+          R partial = reducer;
+          partial.load(in);
+          if (!in.ok()) {
+            return false;
+          }
+          merger.submit(block, std::move(partial));
+          size_t begin = block * kBlockSize;
+          progress.add(worker,
+                       std::min(begin + kBlockSize, simulations) - begin);
+          return true;
+        });
+    if (!complete) {
+      throw std::runtime_error("run_reduce: every worker process failed");
     }
+    return total;
+  }
 
-    return results;
+  // Batch path for experiments that are a plain function of Dims uniforms on
+  // [0, 1). Instead of drawing through RNG one sample at a time, the runner
+  // fills kBatchSize uniforms per dimension with the SIMD UniformBatchEngine
+  // and maps the kernel over the whole batch before folding it into
+  // `reducer`. The stream depends only on the seed, as in run_reduce.
+  template <size_t Dims, typename K,
+            typename T =
+                std::invoke_result_t<K, const std::array<double, Dims>&>,
+            Reducer<T> R>
+  R run_uniform(K&& kernel, size_t simulations, R reducer,
+                bool show_progress = true) {
+    R total = reducer;
+    BlockMerger<R> merger(total);
+
+    for_each_block(
+        simulations, show_progress,
+        [&](size_t block, size_t begin, size_t end, RNG&, ScratchArena&) {
+          UniformBatchEngine engine(m_seed, block);
+          std::decay_t<K> local(kernel);
+          R partial = reducer;
+
+          std::array<std::array<double, kBatchSize>, Dims> columns;
+          std::array<T, kBatchSize> results;
+          for (size_t i = begin; i < end; i += kBatchSize) {
+            size_t n = std::min(kBatchSize, end - i);
+            for (auto& column : columns) {
+              engine.fill(column.data(), kBatchSize);
+            }
+            for (size_t j = 0; j < n; j++) {
+              std::array<double, Dims> point;
+              for (size_t d = 0; d < Dims; d++) {
+                point[d] = columns[d][j];
+              }
+              results[j] = local(point);
+            }
+            add_all(partial, std::span<const T>(results.data(), n));
+          }
+          merger.submit(block, std::move(partial));
+        });
+
+    return total;
+  }
+
+  // Estimates the mean of kernel(u) over Dims uniforms on the batch path of
+  // run_uniform, with the points laid out by `sampling` (see
+  // variance_reduction.hpp). The estimate reports its variance reduction
+  // against plain sampling of the same number of points.
+  template <size_t Dims, typename K>
+  Estimate estimate_uniform(K&& kernel, size_t simulations,
+                            Sampling sampling = Sampling::kPlain,
+                            bool show_progress = true) {
+    return estimate_uniform<Dims>(kernel, NoControl{}, 0.0, simulations,
+                                  sampling, show_progress);
+  }
+
+  // Same, corrected by the control variate control(u), whose exact mean is
+  // control_mean. The regression coefficient is fitted on the run itself.
+  template <size_t Dims, typename K, typename C>
+  Estimate estimate_uniform(K&& kernel, C&& control, double control_mean,
+                            size_t simulations,
+                            Sampling sampling = Sampling::kPlain,
+                            bool show_progress = true) {
+    DesignMoments total;
+    BlockMerger<DesignMoments> merger(total);
+
+    for_each_block(
+        simulations, show_progress,
+        [&](size_t block, size_t begin, size_t end, RNG&, ScratchArena&) {
+          UniformBatchEngine engine(m_seed, block);
+          // Same starting state as the engine's first lane; the jump puts
+          // the strata permutations 2^128 draws away from its uniforms.
+          Xoshiro256pp strata(m_seed, block);
+          strata.jump();
+          std::decay_t<K> local(kernel);
+          std::decay_t<C> local_control(control);
+          DesignMoments partial;
+
+          std::array<std::array<double, kBatchSize>, Dims> columns;
+          for (size_t i = begin; i < end; i += kBatchSize) {
+            size_t n = std::min(kBatchSize, end - i);
+            fill_design(sampling, n, engine, strata, columns);
+
+            size_t unit = design_unit(sampling, n);
+            for (size_t first = 0; first < n; first += unit) {
+              size_t last = std::min(first + unit, n);
+              double value_sum = 0.0;
+              double control_sum = 0.0;
+              for (size_t j = first; j < last; j++) {
+                std::array<double, Dims> point;
+                for (size_t d = 0; d < Dims; d++) {
+                  point[d] = columns[d][j];
+                }
+                double value = static_cast<double>(local(point));
+                partial.add_value(value);
+                value_sum += value;
+                control_sum += local_control(point);
+              }
+              double size = static_cast<double>(last - first);
+              partial.add_unit(value_sum / size, control_sum / size);
+            }
+          }
+          merger.submit(block, std::move(partial));
+        });
+
+    return total.estimate(control_mean, 0.95);
+  }
+
+  // Quasi-Monte Carlo estimate of the mean of kernel(u) over Dims uniforms,
+  // with u running through a low-discrepancy Sequence (SobolSequence or
+  // HaltonSequence) instead of random points. The simulations are split
+  // into `replicates` independently randomized copies of the sequence whose
+  // spread gives the confidence interval, with Student's t quantile for
+  // replicates - 1 degrees of freedom. Every replicate is cut into blocks that the
+  // threads generate by seeking into the sequence. A kernel returning
+  // std::array<T, N> gets N estimates back, all from the same points.
+  // Throws std::invalid_argument for fewer than two replicates, which leave
+  // no spread to estimate the error from.
+  template <size_t Dims, typename Sequence = SobolSequence, typename K>
+  auto estimate_qmc(K&& kernel, size_t simulations, size_t replicates = 32,
+                    bool show_progress = true) {
+    static_assert(Dims <= Sequence::kMaxDims);
+    using kernel_result =
+        std::decay_t<std::invoke_result_t<K&, const std::array<double, Dims>&>>;
+    constexpr size_t outputs = kQmcOutputs<kernel_result>;
+    if (replicates < 2) {
+      throw std::invalid_argument("estimate_qmc: " +
+                                  std::to_string(replicates) +
+                                  " replicates, at least 2 needed");
+    }
+    const size_t points = std::max<size_t>(simulations / replicates, 1);
+
+    // sums[r * outputs + k] is output k summed over replicate r.
+    struct Partial {
+      std::array<MeanVariance, outputs> values;
+      std::vector<double> sums;
+
+      void merge(const Partial& other) {
+        for (size_t k = 0; k < outputs; k++) {
+          values[k].merge(other.values[k]);
+        }
+        for (size_t r = 0; r < sums.size(); r++) {
+          sums[r] += other.sums[r];
+        }
+      }
+    };
+
+    Partial total{{}, std::vector<double>(replicates * outputs)};
+    BlockMerger<Partial> merger(total);
+
+    for_each_block(
+        points * replicates, show_progress,
+        [&](size_t block, size_t begin, size_t end, RNG&, ScratchArena&) {
+          std::decay_t<K> local(kernel);
+          Partial partial{{}, std::vector<double>(replicates * outputs)};
+          std::array<double, Dims> point;
+
+          auto add = [&](size_t replicate, size_t k, double value) {
+            partial.values[k].add(value);
+            partial.sums[replicate * outputs + k] += value;
+          };
+
+          for (size_t i = begin; i < end;) {
+            size_t replicate = i / points;
+            size_t last = std::min(end, (replicate + 1) * points);
+            uint64_t mix = replicate;
+            Sequence sequence(Dims, m_seed ^ splitmix64(mix));
+            sequence.seek(i - replicate * points);
+            for (; i < last; i++) {
+              sequence.next(point);
+              if constexpr (outputs == 1) {
+                add(replicate, 0, static_cast<double>(local(point)));
+              } else {
+                auto values = local(point);
+                for (size_t k = 0; k < outputs; k++) {
+                  add(replicate, k, static_cast<double>(values[k]));
+                }
+              }
+            }
+          }
+          merger.submit(block, std::move(partial));
+        });
+
+    std::array<Estimate, outputs> estimates;
+    for (size_t k = 0; k < outputs; k++) {
+      DesignMoments moments;
+      moments.add_values(total.values[k]);
+      for (size_t r = 0; r < replicates; r++) {
+        moments.add_unit(total.sums[r * outputs + k] / static_cast<double>(points),
+                         0.0);
+      }
+      estimates[k] = moments.estimate(0.0, 0.95);
+    }
+    if constexpr (outputs == 1) {
+      return estimates[0];
+    } else {
+      return estimates;
+    }
+  }
+
+  // Sequential stopping: simulates in rounds of blocks and stops as soon as
+  // the confidence interval of the mean result meets `target`, or after
+  // max_simulations. The experiment must return something convertible to
+  // double (a bool gives a probability). Rounds default to one block per
+  // thread, so the stopping point depends on the seed and thread count.
+  template <Experiment<RNG> E>
+    requires std::convertible_to<experiment_result_t<E, RNG>, double>
+  Estimate run_until(E&& experiment, Precision target,
+                     size_t max_simulations, bool show_progress = true) {
+    const size_t blocks = block_count(max_simulations);
+    const size_t round =
+        target.blocks_per_check != 0 ? target.blocks_per_check : m_threads;
+
+    MeanVariance stats;
+    BlockMerger<MeanVariance> merger(stats);
+    Estimate estimate;
+    ProgressReporter progress(max_simulations, m_threads, show_progress);
+
+    for (size_t first = 0; first < blocks; first += round) {
+      size_t last = std::min(first + round, blocks);
+      for_each_block(m_seed, first, last, max_simulations, progress,
+                     [&](size_t block, size_t begin, size_t end, RNG& rng,
+                         ScratchArena& scratch) {
+                       std::decay_t<E> local(experiment);
+                       MeanVariance partial;
+                       for (size_t i = begin; i < end; i++) {
+                         partial.add(invoke_sample(local, rng, scratch, i));
+                       }
+                       merger.submit(block, std::move(partial));
+                     });
+
+      estimate = Estimate::from(stats, target.confidence);
+      if (target.reached(estimate)) {
+        estimate.converged = true;
+        break;
+      }
+    }
+    return estimate;
+  }
+
+  // Finds the smallest parameter n at which an event becomes more likely
+  // than search.probability, for an event that only gets more likely as n
+  // grows (more shots, more students, a longer horizon). Instead of a full
+  // run per candidate n, every sample path answers all of them at once with
+  // common random numbers: the experiment returns the critical parameter of
+  // its path, the smallest n for which the event happens on it (any value
+  // past the range of interest if it never does). Blocks are added in
+  // rounds until the confidence intervals separate the answer from its
+  // predecessor and meet search.half_width, or max_simulations is spent.
+  template <Experiment<RNG> E>
+    requires Reducer<Tally<size_t>, experiment_result_t<E, RNG>>
+  Threshold find_threshold(E&& experiment, const ThresholdSearch& search,
+                           size_t max_simulations, bool show_progress = true) {
+    const size_t blocks = block_count(max_simulations);
+    const size_t round =
+        search.blocks_per_check != 0 ? search.blocks_per_check : m_threads;
+
+    Tally<size_t> critical;
+    BlockMerger<Tally<size_t>> merger(critical);
+    Threshold threshold;
+    ProgressReporter progress(max_simulations, m_threads, show_progress);
+
+    for (size_t first = 0; first < blocks; first += round) {
+      size_t last = std::min(first + round, blocks);
+      for_each_block(m_seed, first, last, max_simulations, progress,
+                     [&](size_t block, size_t begin, size_t end, RNG& rng,
+                         ScratchArena& scratch) {
+                       std::decay_t<E> local(experiment);
+                       Tally<size_t> partial;
+                       for (size_t i = begin; i < end; i++) {
+                         partial.add(invoke_sample(local, rng, scratch, i));
+                       }
+                       merger.submit(block, std::move(partial));
+                     });
+
+      threshold = locate_threshold(critical, search);
+      if (threshold.converged) {
+        break;
+      }
+    }
+    return threshold;
+  }
+
+  // Exact outcome distribution of the experiment, found by enumerating every
+  // sequence of choices it can make on the runner's threads (see
+  // enumerate.hpp). nullopt when there are more than max_paths sequences or
+  // the experiment draws in a way that cannot be enumerated. Tasks simulate
+  // either way and check the simulation against it with
+  // report_probability.
+  template <typename E>
+  auto enumerate(const E& experiment, size_t max_paths = 1 << 20) const {
+    return ::enumerate(experiment, max_paths, m_threads);
+  }
+
+  // Re-runs simulation `index` of a run with this seed and returns its
+  // result. Counter-based engines jump straight to the sample; other engines
+  // replay the preceding samples of its block.
+  template <Experiment<RNG> E>
+  auto replay(E&& experiment, size_t index) {
+    size_t block = index / kBlockSize;
+    RNG rng = make_stream<RNG>(m_seed, block);
+    ScratchArena scratch;
+    if constexpr (!CounterBasedEngine<RNG>) {
+      for (size_t i = block * kBlockSize; i < index; i++) {
+        invoke_sample(experiment, rng, scratch, i);
+      }
+    }
+    return invoke_sample(experiment, rng, scratch, index);
   }
 
  private:
-  void print_progress(size_t current, size_t total) {
-    int pos = static_cast<int>(50.0 * static_cast<double>(current) /
-                               static_cast<double>(total));
-    std::print("\r[{:=>{}}{:<{}}] {:>3}% ", "", pos, "", 50 - pos,
-               100 * current / total);
-    std::cout.flush();
+  // Seed of a runner not given one: TASK_SEED from the environment when it
+  // holds a number, so that a run can be repeated, fresh entropy otherwise.
+  static uint64_t random_seed() {
+    if (const char* env = std::getenv("TASK_SEED")) {
+      std::string_view text(env);
+      uint64_t seed = 0;
+      auto [end, error] =
+          std::from_chars(text.data(), text.data() + text.size(), seed);
+      if (error == std::errc{} && end == text.data() + text.size()) {
+        return seed;
+      }
+    }
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+  }
+
+  template <typename E>
+  static auto invoke_sample(E& experiment, RNG& rng, ScratchArena& scratch,
+                            size_t index) {
+    if constexpr (CounterBasedEngine<RNG>) {
+      rng.seek(index);
+    }
+    if constexpr (std::invocable<E&, RNG&, ScratchArena&>) {
+      auto result = experiment(rng, scratch);
+      scratch.reset();
+      return result;
+    } else {
+      return experiment(rng);
+    }
+  }
+
+  // Uses the reducer's bulk add_all() when it has one.
+  template <typename R, typename T>
+  static void add_all(R& reducer, std::span<const T> values) {
+    if constexpr (requires { reducer.add_all(values); }) {
+      reducer.add_all(values);
+    } else {
+      for (const T& value : values) {
+        reducer.add(value);
+      }
+    }
+  }
+
+  // Merges per-block partial reducers into the total strictly in block order,
+  // parking blocks that finish early until their predecessors arrive. The
+  // total may be of another type that merges partials, such as a file
+  // appending them.
+  template <typename R, typename Total = R>
+  class BlockMerger {
+   public:
+    explicit BlockMerger(Total& total, size_t first_block = 0)
+        : m_total(total), m_next(first_block) {}
+
+    // callback(next_block, total) runs under the merger's lock each time
+    // the merged prefix grows, with total holding blocks below next_block.
+    void on_advance(std::function<void(size_t, const Total&)> callback) {
+      m_on_advance = std::move(callback);
+    }
+
+    void submit(size_t block, R&& partial) {
+      std::lock_guard lock(m_mutex);
+      if (block != m_next) {
+        m_pending.emplace(block, std::move(partial));
+        return;
+      }
+      m_total.merge(partial);
+      m_next++;
+      for (auto it = m_pending.begin();
+           it != m_pending.end() && it->first == m_next;
+           it = m_pending.erase(it)) {
+        m_total.merge(it->second);
+        m_next++;
+      }
+      if (m_on_advance) {
+        m_on_advance(m_next, m_total);
+      }
+      m_advanced.notify_all();
+    }
+
+    // Waits until `block` is less than `window` blocks past the oldest
+    // block not yet merged, so that at most `window` partials are ever
+    // parked. Blocks are handed out in increasing order, so the oldest one
+    // is always running and never waits here.
+    void wait_for_room(size_t block, size_t window) {
+      std::unique_lock lock(m_mutex);
+      m_advanced.wait(lock, [&] { return block < m_next + window; });
+    }
+
+   private:
+    Total& m_total;
+    std::mutex m_mutex;
+    std::condition_variable m_advanced;
+    size_t m_next;
+    std::map<size_t, R> m_pending;
+    std::function<void(size_t, const Total&)> m_on_advance;
+  };
+
+  static size_t block_count(size_t simulations) {
+    return (simulations + kBlockSize - 1) / kBlockSize;
   }
+
+  // Hands blocks out to the workers in increasing order;
+  // body(block, begin, end, rng, scratch) processes the simulations
+  // [begin, end) with the block's own stream and the worker's arena.
+  template <typename Body>
+  void for_each_block(size_t simulations, bool show_progress, Body&& body) {
+    ProgressReporter progress(simulations, m_threads, show_progress);
+    for_each_block(m_seed, 0, block_count(simulations), simulations, progress,
+                   body);
+  }
+
+  // Same, restricted to the blocks [first, last) of a run of `simulations`
+  // with the streams of `seed`. Finished blocks are counted on `progress`.
+  template <typename Body>
+  void for_each_block(uint64_t seed, size_t first, size_t last,
+                      size_t simulations, ProgressReporter& progress,
+                      Body&& body) {
+    const unsigned workers =
+        static_cast<unsigned>(std::clamp<size_t>(last - first, 1, m_threads));
+
+    std::atomic<size_t> next_block{first};
+
+    auto work = [&](unsigned worker) {
+      ScratchArena scratch;
+      for (size_t block = next_block.fetch_add(1, std::memory_order_relaxed);
+           block < last;
+           block = next_block.fetch_add(1, std::memory_order_relaxed)) {
+        size_t begin = block * kBlockSize;
+        size_t end = std::min(begin + kBlockSize, simulations);
+
+        RNG rng = make_stream<RNG>(seed, block);
+        body(block, begin, end, rng, scratch);
+        progress.add(worker, end - begin);
+      }
+    };
+
+    {
+      std::vector<std::jthread> pool;
+      pool.reserve(workers - 1);
+      for (unsigned w = 1; w < workers; w++) {
+        pool.emplace_back(work, w);
+      }
+      work(0);
+    }
+  }
+
+  uint64_t m_seed;
+  unsigned m_threads;
 };
 
+// Chance that a task whose simulation and enumeration are both right still
+// reports a mismatch, over all of its checks together.
+inline constexpr double kMismatchRate = 1e-9;
+
+// Prints the simulated probability of an event seen `hits` times in `total`
+// simulations with its 99.9% confidence interval, followed by the exact
+// probability of pred when enumeration found one. Returns false if the two
+// differ by more than a correct run would, one time in 1 / kMismatchRate,
+// among the `checks` calls the task makes (Bonferroni), so a false return
+// points at a bug rather than at bad luck.
+template <typename T, typename Pred>
+bool report_probability(std::string_view event, size_t hits, size_t total,
+                        const std::optional<Enumeration<T>>& exact,
+                        Pred&& pred, size_t checks = 1) {
+  auto simulated = Estimate::proportion(hits, total, 0.999);
+  std::print("{} = {:.6f} ± {:.6f}", event, simulated.mean,
+             simulated.half_width);
+  if (!exact) {
+    std::print("\n");
+    return true;
+  }
+  double p = exact->probability(pred);
+  double tail = kMismatchRate /
+                (2.0 * static_cast<double>(std::max<size_t>(checks, 1)));
+  double bound = normal_quantile(1.0 - tail) * simulated.std_error;
+  double error = std::abs(simulated.mean - p);
+  if (error <= bound) {
+    std::print(" (exact {:.6f})\n", p);
+    return true;
+  }
+  std::print(" (exact {:.6f}, {:.1f} standard errors off)\n", p,
+             error / simulated.std_error);
+  return false;
+}
+
 template <typename T>
-auto tally(const std::vector<T>& results) {
-  std::map<T, size_t> counts;
+Tally<T> tally(const std::vector<T>& results) {
+  Tally<T> counts;
   for (const auto& r : results) {
-    counts[r]++;
+    counts.add(r);
   }
   return counts;
 }
@@ -0,0 +1,106 @@
+#ifndef THRESHOLD_HPP
+#define THRESHOLD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "estimate.hpp"
+#include "tally.hpp"
+
+// Goal and stopping rule for TaskRunner::find_threshold: the smallest
+// parameter n with P(event at n) > probability, for an event that can only
+// become more likely as n grows.
+struct ThresholdSearch {
+  double probability = 0.5;
+  double confidence = 0.95;
+  // Also require the estimate at the answer to be this precise; 0 disables.
+  double half_width = 0.0;
+  // Blocks simulated between two checks; 0 means one block per thread.
+  size_t blocks_per_check = 0;
+};
+
+// Outcome of a threshold search.
+struct Threshold {
+  // False when no parameter seen so far reaches the probability.
+  bool found = false;
+  size_t parameter = 0;
+  // P(event at parameter) and P(event at parameter - 1).
+  Estimate estimate;
+  Estimate previous;
+  // The confidence intervals put parameter above and parameter - 1 below
+  // the probability, and the half_width target (if any) is met.
+  bool converged = false;
+};
+
+// Wilson score interval of a proportion; unlike the normal interval it
+// stays meaningful for counts of 0 or total.
+inline std::pair<double, double> wilson_interval(size_t hits, size_t total,
+                                                 double confidence) {
+  if (total == 0) {
+    return {0.0, 1.0};
+  }
+  double z = normal_quantile(0.5 + confidence / 2.0);
+  double n = static_cast<double>(total);
+  double p = static_cast<double>(hits) / n;
+  double scale = 1.0 + z * z / n;
+  double centre = (p + z * z / (2.0 * n)) / scale;
+  double half =
+      z / scale * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n));
+  return {std::max(centre - half, 0.0), std::min(centre + half, 1.0)};
+}
+
+// Reads the search off the tally of critical parameters, the smallest n at
+// which the event happened on each sample path: P(event at n) is the
+// fraction of paths with critical parameter <= n, a step function that
+// only changes at tallied values, so the answer is found by bisecting the
+// cumulative counts.
+inline Threshold locate_threshold(const Tally<size_t>& critical,
+                                  const ThresholdSearch& search) {
+  const auto entries = critical.entries();
+  const size_t total = critical.total();
+
+  std::vector<size_t> cumulative(entries.size());
+  size_t sum = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    sum += entries[i].second;
+    cumulative[i] = sum;
+  }
+
+  auto above = [&](size_t hits) {
+    return static_cast<double>(hits) >
+           search.probability * static_cast<double>(total);
+  };
+  auto it = std::partition_point(cumulative.begin(), cumulative.end(),
+                                 [&](size_t hits) { return !above(hits); });
+
+  Threshold threshold;
+  if (total == 0 || it == cumulative.end()) {
+    return threshold;
+  }
+  size_t i = static_cast<size_t>(it - cumulative.begin());
+  size_t hits_before = i == 0 ? 0 : cumulative[i - 1];
+
+  threshold.found = true;
+  threshold.parameter = entries[i].first;
+  threshold.estimate =
+      Estimate::proportion(cumulative[i], total, search.confidence);
+  threshold.previous =
+      Estimate::proportion(hits_before, total, search.confidence);
+
+  bool separated =
+      wilson_interval(cumulative[i], total, search.confidence).first >
+          search.probability &&
+      (threshold.parameter == 0 ||
+       wilson_interval(hits_before, total, search.confidence).second <=
+           search.probability);
+  bool precise = search.half_width <= 0.0 ||
+                 threshold.estimate.half_width <= search.half_width;
+  threshold.converged = separated && precise;
+  threshold.estimate.converged = threshold.converged;
+  return threshold;
+}
+
+#endif  // !THRESHOLD_HPP
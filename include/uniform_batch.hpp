@@ -0,0 +1,126 @@
+#ifndef UNIFORM_BATCH_HPP
+#define UNIFORM_BATCH_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "engines.hpp"
+
+// Eight interleaved xoshiro256+ generators stored lane-by-lane, producing
+// uniform doubles in [0, 1) a vector register at a time. The AVX-512, AVX2
+// and scalar paths compute exactly the same numbers, so a seed gives the same
+// run on every machine; only the speed differs.
+class UniformBatchEngine {
+ public:
+  static constexpr size_t kLanes = 8;
+
+  UniformBatchEngine(uint64_t seed, uint64_t stream) {
+    uint64_t mix = stream;
+    uint64_t state = seed ^ splitmix64(mix);
+    for (size_t lane = 0; lane < kLanes; lane++) {
+      for (auto& word : m_s) {
+        word[lane] = splitmix64(state);
+      }
+    }
+  }
+
+  // Writes n uniforms to out; n must be a multiple of kLanes.
+  void fill(double* out, size_t n) {
+#if defined(__AVX512F__)
+    __m512i s0 = _mm512_load_si512(m_s[0].data());
+    __m512i s1 = _mm512_load_si512(m_s[1].data());
+    __m512i s2 = _mm512_load_si512(m_s[2].data());
+    __m512i s3 = _mm512_load_si512(m_s[3].data());
+    const __m512i exponent = _mm512_set1_epi64(kOneBits);
+    const __m512d one = _mm512_set1_pd(1.0);
+    // The unmasked shifts and rotate of GCC 12 pass an undefined vector as
+    // the merge source and trip -Wmaybe-uninitialized; the zero-masked
+    // forms with every lane selected compile to the same instructions.
+    const __mmask8 all = 0xFF;
+    for (size_t i = 0; i < n; i += kLanes) {
+      __m512i result = _mm512_add_epi64(s0, s3);
+      __m512i t = _mm512_maskz_slli_epi64(all, s1, 17);
+      s2 = _mm512_xor_si512(s2, s0);
+      s3 = _mm512_xor_si512(s3, s1);
+      s1 = _mm512_xor_si512(s1, s2);
+      s0 = _mm512_xor_si512(s0, s3);
+      s2 = _mm512_xor_si512(s2, t);
+      s3 = _mm512_maskz_rol_epi64(all, s3, 45);
+      __m512i bits = _mm512_or_si512(
+          _mm512_maskz_srli_epi64(all, result, 12), exponent);
+      _mm512_storeu_pd(out + i,
+                       _mm512_sub_pd(_mm512_castsi512_pd(bits), one));
+    }
+    _mm512_store_si512(m_s[0].data(), s0);
+    _mm512_store_si512(m_s[1].data(), s1);
+    _mm512_store_si512(m_s[2].data(), s2);
+    _mm512_store_si512(m_s[3].data(), s3);
+#elif defined(__AVX2__)
+    for (size_t half = 0; half < kLanes; half += 4) {
+      auto load = [&](size_t word) {
+        return _mm256_load_si256(
+            reinterpret_cast<const __m256i*>(m_s[word].data() + half));
+      };
+      auto store = [&](size_t word, __m256i value) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(m_s[word].data() + half),
+                           value);
+      };
+      __m256i s0 = load(0);
+      __m256i s1 = load(1);
+      __m256i s2 = load(2);
+      __m256i s3 = load(3);
+      const __m256i exponent = _mm256_set1_epi64x(kOneBits);
+      const __m256d one = _mm256_set1_pd(1.0);
+      for (size_t i = 0; i < n; i += kLanes) {
+        __m256i result = _mm256_add_epi64(s0, s3);
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45),
+                             _mm256_srli_epi64(s3, 19));
+        __m256i bits =
+            _mm256_or_si256(_mm256_srli_epi64(result, 12), exponent);
+        _mm256_storeu_pd(out + i + half,
+                         _mm256_sub_pd(_mm256_castsi256_pd(bits), one));
+      }
+      store(0, s0);
+      store(1, s1);
+      store(2, s2);
+      store(3, s3);
+    }
+#else
+    for (size_t i = 0; i < n; i += kLanes) {
+      for (size_t lane = 0; lane < kLanes; lane++) {
+        uint64_t result = m_s[0][lane] + m_s[3][lane];
+        uint64_t t = m_s[1][lane] << 17;
+        m_s[2][lane] ^= m_s[0][lane];
+        m_s[3][lane] ^= m_s[1][lane];
+        m_s[1][lane] ^= m_s[2][lane];
+        m_s[0][lane] ^= m_s[3][lane];
+        m_s[2][lane] ^= t;
+        m_s[3][lane] = std::rotl(m_s[3][lane], 45);
+        out[i + lane] =
+            std::bit_cast<double>((result >> 12) | kOneBits) - 1.0;
+      }
+    }
+#endif
+  }
+
+ private:
+  // Bit pattern of 1.0: OR-ing 52 random mantissa bits into it gives a
+  // uniform double in [1, 2).
+  static constexpr uint64_t kOneBits = 0x3FF0000000000000;
+
+  alignas(64) std::array<std::array<uint64_t, kLanes>, 4> m_s;
+};
+
+#endif  // !UNIFORM_BATCH_HPP
@@ -0,0 +1,192 @@
+#ifndef VARIANCE_REDUCTION_HPP
+#define VARIANCE_REDUCTION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+#include "engines.hpp"
+#include "estimate.hpp"
+#include "reducers.hpp"
+#include "uniform_batch.hpp"
+
+// How TaskRunner::estimate_uniform lays out the uniforms of a batch.
+enum class Sampling {
+  // Independent points.
+  kPlain,
+  // Pairs u, 1 - u; pays off when the kernel is monotone in its inputs.
+  kAntithetic,
+  // A Latin hypercube per batch: along every dimension each of the n
+  // strata [k / n, (k + 1) / n) holds exactly one point.
+  kLatinHypercube,
+};
+
+// Control variate for estimate_uniform that is never used.
+struct NoControl {
+  template <typename Point>
+  double operator()(const Point&) const {
+    return 0.0;
+  }
+};
+
+// Fills the first n entries of every column according to `sampling`.
+// `strata` shuffles the Latin hypercube strata.
+template <size_t Dims, size_t Batch>
+void fill_design(Sampling sampling, size_t n, UniformBatchEngine& engine,
+                 Xoshiro256pp& strata,
+                 std::array<std::array<double, Batch>, Dims>& columns) {
+  for (auto& column : columns) {
+    engine.fill(column.data(), Batch);
+  }
+
+  if (sampling == Sampling::kAntithetic) {
+    for (auto& column : columns) {
+      for (size_t j = 1; j < n; j += 2) {
+        column[j] = 1.0 - column[j - 1];
+      }
+    }
+  } else if (sampling == Sampling::kLatinHypercube) {
+    std::array<uint32_t, Batch> stratum;
+    for (auto& column : columns) {
+      std::iota(stratum.begin(), stratum.begin() + n, 0);
+      std::shuffle(stratum.begin(), stratum.begin() + n, strata);
+      for (size_t j = 0; j < n; j++) {
+        column[j] = (stratum[j] + column[j]) / static_cast<double>(n);
+      }
+    }
+  }
+}
+
+// Number of consecutive points of a batch of n that form one independent
+// replicate under `sampling`.
+inline size_t design_unit(Sampling sampling, size_t n) {
+  switch (sampling) {
+    case Sampling::kAntithetic:
+      return 2;
+    case Sampling::kLatinHypercube:
+      return n;
+    default:
+      return 1;
+  }
+}
+
+// Means, variances and covariance of pairs (x, y), merged like
+// MeanVariance.
+class Comoments {
+ public:
+  void add(double x, double y) {
+    m_count++;
+    double n = static_cast<double>(m_count);
+    double dx = x - m_mean_x;
+    double dy = y - m_mean_y;
+    m_mean_x += dx / n;
+    m_mean_y += dy / n;
+    m_m2_x += dx * (x - m_mean_x);
+    m_m2_y += dy * (y - m_mean_y);
+    m_c_xy += dx * (y - m_mean_y);
+  }
+
+  void merge(const Comoments& other) {
+    if (other.m_count == 0) {
+      return;
+    }
+    if (m_count == 0) {
+      *this = other;
+      return;
+    }
+    double n_a = static_cast<double>(m_count);
+    double n_b = static_cast<double>(other.m_count);
+    double n = n_a + n_b;
+    double dx = other.m_mean_x - m_mean_x;
+    double dy = other.m_mean_y - m_mean_y;
+    m_mean_x += dx * n_b / n;
+    m_mean_y += dy * n_b / n;
+    m_m2_x += other.m_m2_x + dx * dx * n_a * n_b / n;
+    m_m2_y += other.m_m2_y + dy * dy * n_a * n_b / n;
+    m_c_xy += other.m_c_xy + dx * dy * n_a * n_b / n;
+    m_count += other.m_count;
+  }
+
+  size_t count() const { return m_count; }
+  double mean_x() const { return m_mean_x; }
+  double mean_y() const { return m_mean_y; }
+  double variance_x() const { return normalise(m_m2_x); }
+  double variance_y() const { return normalise(m_m2_y); }
+  double covariance() const { return normalise(m_c_xy); }
+
+ private:
+  double normalise(double sum) const {
+    return m_count < 2 ? 0.0 : sum / static_cast<double>(m_count - 1);
+  }
+
+  size_t m_count = 0;
+  double m_mean_x = 0.0;
+  double m_mean_y = 0.0;
+  double m_m2_x = 0.0;
+  double m_m2_y = 0.0;
+  double m_c_xy = 0.0;
+};
+
+// What estimate_uniform collects per block: every kernel value, for the
+// variance plain sampling would have had, and the (kernel, control) means of
+// every independent replicate, which carry the actual estimator.
+class DesignMoments {
+ public:
+  void add_value(double value) { m_values.add(value); }
+  void add_values(const MeanVariance& values) { m_values.merge(values); }
+  void add_unit(double value, double control) { m_units.add(value, control); }
+
+  void merge(const DesignMoments& other) {
+    m_values.merge(other.m_values);
+    m_units.merge(other.m_units);
+  }
+
+  // The estimate, corrected by the control variate with the regression
+  // coefficient fitted on the same units (zero without a control), and its
+  // variance reduction against plain sampling of the same number of points.
+  Estimate estimate(double control_mean, double confidence) const {
+    double beta = m_units.variance_y() > 0.0
+                      ? m_units.covariance() / m_units.variance_y()
+                      : 0.0;
+    double unit_variance = m_units.variance_x() -
+                           2.0 * beta * m_units.covariance() +
+                           beta * beta * m_units.variance_y();
+
+    Estimate estimate;
+    estimate.mean = m_units.mean_x() - beta * (m_units.mean_y() - control_mean);
+    estimate.std_error =
+        m_units.count() == 0
+            ? 0.0
+            : std::sqrt(std::max(unit_variance, 0.0) /
+                        static_cast<double>(m_units.count()));
+    // Student's t, since the units may be as few as the replicates of
+    // estimate_qmc.
+    estimate.half_width =
+        m_units.count() < 2
+            ? 0.0
+            : student_t_quantile(0.5 + confidence / 2.0,
+                                 static_cast<double>(m_units.count() - 1)) *
+                  estimate.std_error;
+    estimate.confidence = confidence;
+    estimate.simulations = m_values.count();
+
+    double plain = m_values.std_error();
+    if (estimate.std_error > 0.0) {
+      estimate.variance_reduction =
+          plain * plain / (estimate.std_error * estimate.std_error);
+    } else if (plain > 0.0) {
+      estimate.variance_reduction = std::numeric_limits<double>::infinity();
+    }
+    return estimate;
+  }
+
+ private:
+  MeanVariance m_values;
+  Comoments m_units;
+};
+
+#endif  // !VARIANCE_REDUCTION_HPP
@@ -1,4 +1,5 @@
 #include <cstdlib>
+#include <functional>
 #include <print>
 
 #include "task_runner.hpp"
@@ -11,22 +12,18 @@ int main() {
   TaskRunner runner;
 
   auto experiment = [total, broken](auto& rng) {
-    std::vector<int> deck(total);
-    std::iota(deck.begin(), deck.end(), 0);
-
-    std::vector<int> hand(2);
-    std::sample(deck.begin(), deck.end(), hand.begin(), 2, rng);
-    return hand[0] >= broken && hand[1] >= broken;
+    return hypergeometric(total, broken, 2, rng) == 0;
   };
 
   std::print("Powering on device with 2 broken sensors\n");
-  auto results = runner.run(experiment, simulations);
+  auto exact = runner.enumerate(experiment);
+  auto counts =
+      runner.run_reduce(experiment, simulations, Histogram<bool>{});
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(powers on) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(not powers off) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  bool agrees = report_probability("P(powers on)", counts[true], simulations,
+                                   exact, std::identity{}, 2);
+  agrees &= report_probability("P(not powers off)", counts[false],
+                               simulations, exact, std::logical_not{}, 2);
+  return agrees ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -14,23 +14,16 @@ int main() {
   TaskRunner runner;
 
   auto experiment = [total, high_grade, taken, target](auto& rng) {
-    std::vector<int> students(total, 0);
-    std::fill(students.begin(), students.begin() + high_grade, 1);
-
-    std::vector<int> hand(taken);
-    std::sample(students.begin(), students.end(), hand.begin(), taken, rng);
-
-    int count = std::count(hand.begin(), hand.end(), 1);
+    int count = hypergeometric(total, high_grade, taken, rng);
 
     return count == target;
   };
 
   std::print("Taking students from list\n");
-  auto results = runner.run(experiment, simulations);
+  auto counts =
+      runner.run_reduce(experiment, simulations, Histogram<bool>{});
   std::println();
 
-  auto counts = tally(results);
-
   std::print("P(5 with high grades from 8 taken) = {:.6f}\n",
              static_cast<double>(counts[true]) / simulations);
   std::print("P(not 5 with high grades from 8 taken) = {:.6f}\n",
@@ -13,23 +13,16 @@ int main() {
   TaskRunner runner;
 
   auto experiment = [total, valid, taken](auto& rng) {
-    std::vector<int> deck(total, 0);
-    std::fill(deck.begin(), deck.begin() + valid, 1);
-
-    std::vector<int> hand(taken);
-    std::sample(deck.begin(), deck.end(), hand.begin(), taken, rng);
-
-    int count = std::count(hand.begin(), hand.end(), 1);
+    int count = hypergeometric(total, valid, taken, rng);
 
     return count;
   };
 
   std::print("Taking parts from the box\n");
-  auto results = runner.run(experiment, simulations);
+  auto counts =
+      runner.run_reduce(experiment, simulations, Histogram<int>{});
   std::println();
 
-  auto counts = tally(results);
-
   std::print("P(one part is colored) = {:.6f}\n",
              static_cast<double>(counts[1]) / simulations);
 
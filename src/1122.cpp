@@ -7,22 +7,26 @@ int main() {
   int total = 1000;
 
   size_t simulations = 1e7;
+  double relative_error = 1e-3;
 
   TaskRunner runner;
 
+  // Importance sampling: the proposal tries the right combination (0) half
+  // of the time instead of once in total + 1, and the likelihood ratio
+  // weighs every opening back down.
   auto experiment = [total](auto& rng) {
-    std::uniform_int_distribution<int> dist(0, total);
-    return dist(rng) == 0;
+    LikelihoodRatio ratio;
+    bool right = ratio.uniform_index(rng, total + 1, 0, 0.5) == 0;
+    return ratio.weigh(right);
   };
 
   std::print("Unlocking lock with 4 axis\n");
-  auto results = runner.run(experiment, simulations);
+  auto p_right = runner.run_until(
+      experiment, Precision{.relative_error = relative_error}, simulations);
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(right_combo) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(wrong_combo) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  std::print("P(right_combo) = {:.6f} ± {:.6f} ({} simulations)\n",
+             p_right.mean, p_right.half_width, p_right.simulations);
+  std::print("P(wrong_combo) = {:.6f} ± {:.6f}\n", 1.0 - p_right.mean,
+             p_right.half_width);
 }
@@ -11,17 +11,15 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [total, valid](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, total);
-    return dist(rng) < valid;
+  auto experiment = [total, valid](const auto& u) {
+    return u[0] * total < valid;
   };
 
   std::print("Putting a dot on a line\n");
-  auto results = runner.run(experiment, simulations);
+  auto counts =
+      runner.run_uniform<1>(experiment, simulations, Histogram<bool>{});
   std::println();
 
-  auto counts = tally(results);
-
   std::print("P(in the smaller segment) = {:.6f}\n",
              static_cast<double>(counts[true]) / simulations);
   std::print("P(not in the smaller segment) = {:.6f}\n",
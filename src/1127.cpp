@@ -11,21 +11,20 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [total, valid](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, total);
-    auto point = dist(rng);
+  auto experiment = [total, valid](const auto& u) {
+    auto point = total * u[0];
     auto segment_len = std::min(total - point, point);
     return segment_len > valid;
   };
 
   std::print("Putting a dot on a line\n");
-  auto results = runner.run(experiment, simulations);
+  auto bigger = runner.estimate_uniform<1>(experiment, simulations,
+                                           Sampling::kLatinHypercube);
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(segment bigger than L/3) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(segment smaller than L/3) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  std::print("P(segment bigger than L/3) = {:.6f} ± {:.6f}\n", bigger.mean,
+             bigger.half_width);
+  std::print("P(segment smaller than L/3) = {:.6f} ± {:.6f}\n",
+             1.0 - bigger.mean, bigger.half_width);
+  std::print("Variance reduction x{:.1f}\n", bigger.variance_reduction);
 }
@@ -11,21 +11,22 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [bigger_r, smaller_r](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, bigger_r);
-    auto point_distance = dist(rng);
+  auto experiment = [bigger_r, smaller_r](const auto& u) {
+    auto point_distance = u[0] * bigger_r;
     return point_distance < smaller_r ||
            std::abs(smaller_r - point_distance) < 1e-9;
   };
 
+  // The event only gets less likely as u grows, so pairing u with 1 - u
+  // makes the two halves of a pair negatively correlated.
   std::print("Putting a dot in a circle\n");
-  auto results = runner.run(experiment, simulations);
+  auto inside = runner.estimate_uniform<1>(experiment, simulations,
+                                           Sampling::kAntithetic);
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(in the smaller circle) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(not in the smaller circle) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
-}
\ No newline at end of file
+  std::print("P(in the smaller circle) = {:.6f} ± {:.6f}\n", inside.mean,
+             inside.half_width);
+  std::print("P(not in the smaller circle) = {:.6f} ± {:.6f}\n",
+             1.0 - inside.mean, inside.half_width);
+  std::print("Variance reduction x{:.1f}\n", inside.variance_reduction);
+}
@@ -10,20 +10,23 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [a](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, 2 * a);
-    auto point = dist(rng);
+  auto experiment = [a](const auto& u) {
+    auto point = u[0] * 2 * a;
     return point > 0 && point < a;
   };
 
+  // The coin's position itself, whose mean is known, is strongly correlated
+  // with where it lands.
+  auto position = [](const auto& u) { return u[0]; };
+
   std::print("Tossing coin to the surface\n");
-  auto results = runner.run(experiment, simulations);
+  auto not_crossed = runner.estimate_uniform<1>(experiment, position, 0.5,
+                                                simulations);
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(not crossed any lines) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(crossed a line) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  std::print("P(not crossed any lines) = {:.6f} ± {:.6f}\n", not_crossed.mean,
+             not_crossed.half_width);
+  std::print("P(crossed a line) = {:.6f} ± {:.6f}\n", 1.0 - not_crossed.mean,
+             not_crossed.half_width);
+  std::print("Variance reduction x{:.1f}\n", not_crossed.variance_reduction);
 }
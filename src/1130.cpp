@@ -10,21 +10,18 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [a](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, a);
-    auto x = dist(rng);
-    auto y = dist(rng);
+  auto experiment = [a](const auto& u) {
+    auto x = u[0] * a;
+    auto y = u[1] * a;
     return x > 0 && x < a / 2 && y > 0 && y < a / 2;
   };
 
   std::print("Tossing coin to the surface\n");
-  auto results = runner.run(experiment, simulations);
+  auto not_crossed = runner.estimate_qmc<2>(experiment, simulations);
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(not crossed any lines) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(crossed a line) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  std::print("P(not crossed any lines) = {:.6f} ± {:.6f}\n", not_crossed.mean,
+             not_crossed.half_width);
+  std::print("P(crossed a line) = {:.6f} ± {:.6f}\n", 1.0 - not_crossed.mean,
+             not_crossed.half_width);
 }
@@ -11,18 +11,16 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [r, R](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, R);
-    auto point = dist(rng);
+  auto experiment = [r, R](const auto& u) {
+    auto point = u[0] * R;
     return point > r;
   };
 
   std::print("Tossing coin to the surface\n");
-  auto results = runner.run(experiment, simulations);
+  auto counts =
+      runner.run_uniform<1>(experiment, simulations, Histogram<bool>{});
   std::println();
 
-  auto counts = tally(results);
-
   std::print("P(not crossed any lines) = {:.6f}\n",
              static_cast<double>(counts[true]) / simulations);
   std::print("P(crossed a line) = {:.6f}\n",
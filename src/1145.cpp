@@ -9,21 +9,19 @@ int main() {
 
   TaskRunner runner;
 
-  auto experiment = [](auto& rng) {
-    std::uniform_real_distribution<double> dist(0, 1);
-    auto x = dist(rng);
-    auto y = dist(rng);
+  auto experiment = [](const auto& u) {
+    auto x = u[0];
+    auto y = u[1];
     return x + y < 1.0 && (x * y > 0.09 || std::abs(x - y) < 1e-9);
   };
 
   std::print("Taking x and y from [0,1]\n");
-  auto results = runner.run(experiment, simulations);
+  auto inside = runner.estimate_qmc<2>(experiment, simulations);
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(x + y < 1.0 && xy >= 0.09) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(x + y >= 1.0 || xy < 0.09) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  std::print("P(x + y < 1.0 && xy >= 0.09) = {:.6f} ± {:.6f}\n", inside.mean,
+             inside.half_width);
+  std::print("P(x + y >= 1.0 || xy < 0.09) = {:.6f} ± {:.6f}\n",
+             1.0 - inside.mean, inside.half_width);
+  std::print("Variance reduction x{:.1f}\n", inside.variance_reduction);
 }
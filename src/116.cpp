@@ -1,10 +1,11 @@
 #include <cstdlib>
 #include <print>
 #include <random>
+#include <string_view>
 
 #include "task_runner.hpp"
 
-int main() {
+int main(int argc, char** argv) {
   int n = 10;
   size_t simulations = 1e8;
 
@@ -31,11 +32,16 @@ int main() {
   };
 
   std::print("Cube painting experiment ({}x{}x{} small cubes)\n", n, n, n);
-  auto results = runner.run(experiment, simulations);
+  // With --processes the blocks run in worker processes instead of threads;
+  // a worker that crashes or hangs has its blocks rerun by the others.
+  bool processes = argc > 1 && std::string_view(argv[1]) == "--processes";
+  auto counts = processes ? runner.run_reduce(experiment, simulations,
+                                              Histogram<int>{},
+                                              Processes{runner.threads()})
+                          : runner.run_reduce(experiment, simulations,
+                                              Histogram<int>{});
   std::println();
 
-  auto counts = tally(results);
-
   for (int faces = 1; faces <= 3; faces++) {
     size_t count = counts[faces];
     double prob = double(count) / simulations;
@@ -1,6 +1,6 @@
 #include <cstdlib>
+#include <functional>
 #include <print>
-#include <random>
 
 #include "task_runner.hpp"
 
@@ -12,8 +12,7 @@ int main() {
 
   auto experiment = [n](auto& rng) {
     for (int i = 0; i < n; i++) {
-      std::uniform_int_distribution<int> dist(i, n - 1);
-      if (dist(rng) != i) {
+      if (uniform_int(rng, i, n - 1) != i) {
         return false;
       }
     }
@@ -21,13 +20,14 @@ int main() {
   };
 
   std::print("Take cubes from the box in order)\n", n, n, n);
-  auto results = runner.run(experiment, simulations);
+  auto exact = runner.enumerate(experiment);
+  auto counts =
+      runner.run_reduce(experiment, simulations, Histogram<bool>{});
   std::println();
 
-  auto counts = tally(results);
-
-  std::print("P(taked in order) = {:.6f}\n",
-             static_cast<double>(counts[true]) / simulations);
-  std::print("P(taked not in order) = {:.6f}\n",
-             static_cast<double>(counts[false]) / simulations);
+  bool agrees = report_probability("P(taked in order)", counts[true],
+                                   simulations, exact, std::identity{}, 2);
+  agrees &= report_probability("P(taked not in order)", counts[false],
+                               simulations, exact, std::logical_not{}, 2);
+  return agrees ? EXIT_SUCCESS : EXIT_FAILURE;
 }
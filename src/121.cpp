@@ -22,33 +22,30 @@ int main(int argc, char** argv) {
 
   TaskRunner runner;
 
-  auto experiment_fixed_indices = [alphabet_size](auto& rng) {
-    std::uniform_int_distribution<size_t> dist1(1, alphabet_size);
-    size_t first = dist1(rng);
-
-    std::vector<size_t> remaining;
-    remaining.reserve(alphabet_size - 1);
-    for (size_t i = 1; i <= alphabet_size; i++) {
-      if (i != first) {
-        remaining.push_back(i);
-      }
-    }
-
-    std::uniform_int_distribution<size_t> dist2(0, remaining.size() - 1);
-    size_t second = remaining[dist2(rng)];
+  auto experiment_fixed_indices = [alphabet_size](auto& rng,
+                                                  ScratchArena& scratch) {
+    // The second letter is drawn from those left after the first, which is
+    // what the first two steps of a shuffle do.
+    auto letters = scratch.make<size_t>(alphabet_size);
+    std::iota(letters.begin(), letters.end(), 1);
+    auto drawn = partial_shuffle(letters, 2, rng);
+    size_t first = drawn[0];
+    size_t second = drawn[1];
 
     return Outcome{first % 2 == 0, second % 2 == 0};
   };
 
-  auto experiment_reindexed = [alphabet_size](auto& rng) {
-    std::vector<size_t> indices(alphabet_size);
-    std::iota(indices.begin(), indices.end(), 1);
+  auto experiment_reindexed = [alphabet_size](auto& rng,
+                                              ScratchArena& scratch) {
+    auto all_indices = scratch.make<size_t>(alphabet_size);
+    std::iota(all_indices.begin(), all_indices.end(), 1);
 
-    std::uniform_int_distribution<size_t> dist1(0, indices.size() - 1);
+    std::uniform_int_distribution<size_t> dist1(0, all_indices.size() - 1);
     size_t first_pos = dist1(rng);
     bool first_even = (first_pos + 1) % 2 == 0;
 
-    indices.erase(indices.begin() + first_pos);
+    std::shift_left(all_indices.begin() + first_pos, all_indices.end(), 1);
+    auto indices = all_indices.first(all_indices.size() - 1);
 
     std::uniform_int_distribution<size_t> dist2(0, indices.size() - 1);
     size_t second_pos = dist2(rng);
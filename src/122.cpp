@@ -1,4 +1,3 @@
-#include <algorithm>
 #include <cstdlib>
 #include <numeric>
 #include <print>
@@ -23,13 +22,16 @@ int main(int argc, char** argv) {
 
   TaskRunner runner;
 
-  auto experiment = [N, i, j](auto& rng) {
-    std::vector<size_t> perm(N);
+  // Any two fixed positions of a random permutation hold a random ordered
+  // pair of distinct elements, so the first two draws of a partial shuffle
+  // stand for the elements at positions i and j.
+  auto experiment = [N, i, j](auto& rng, ScratchArena& scratch) {
+    auto perm = scratch.make<size_t>(N);
     std::iota(perm.begin(), perm.end(), 1);
-    std::shuffle(perm.begin(), perm.end(), rng);
+    auto drawn = partial_shuffle(perm, 2, rng);
 
-    bool Ai = perm[i - 1] == i;
-    bool Aj = perm[j - 1] == j;
+    bool Ai = drawn[0] == i;
+    bool Aj = drawn[1] == j;
 
     return Outcome{Ai, Aj};
   };
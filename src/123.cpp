@@ -1,13 +1,10 @@
 #include <cstdlib>
 #include <print>
 #include <random>
+#include <vector>
 
 #include "task_runner.hpp"
 
-struct Outcome {
-  size_t tosses;
-};
-
 int main(int argc, char** argv) {
   if (argc < 2) {
     std::print("Usage: {} <k>\n", argv[0]);
@@ -33,21 +30,23 @@ int main(int argc, char** argv) {
       last = curr;
     }
 
-    return Outcome{tosses};
+    return tosses;
   };
 
   std::print("Coin toss experiment (stop after 2 consecutive same sides)\n");
-  auto results = runner.run(experiment, simulations);
+  // Saves progress every minute; rerunning after a crash resumes from it.
+  auto counts = runner.run_reduce(experiment, simulations, Histogram<size_t>{},
+                                  Checkpoint{"123.ckpt"});
 
   size_t before_k = 0;
   size_t even_tosses = 0;
 
-  for (const auto& r : results) {
-    if (r.tosses < k) {
-      before_k++;
+  for (const auto& [tosses, count] : counts.entries()) {
+    if (tosses < k) {
+      before_k += count;
     }
-    if (r.tosses % 2 == 0) {
-      even_tosses++;
+    if (tosses % 2 == 0) {
+      even_tosses += count;
     }
   }
 
@@ -60,4 +59,49 @@ int main(int argc, char** argv) {
   std::print("P(experiment finishes before k tosses) = {:.6f}\n", p_before_k);
   std::print("P(experiment finishes with even number of tosses) = {:.6f}\n",
              p_even);
+
+  if (k <= 2) {
+    return 0;
+  }
+
+  // Lasting k tosses or more is rare for large k and plain sampling stops
+  // seeing it; multilevel splitting restarts the runs that survived every
+  // toss count 2, ..., k - 1 instead.
+  struct Run {
+    int last;
+    size_t tosses;
+  };
+
+  auto start = [](auto& rng) { return Run{uniform_int(rng, 0, 1), 1}; };
+
+  auto advance = [](Run& run, auto& rng) {
+    int curr = uniform_int(rng, 0, 1);
+    if (curr == run.last) {
+      return false;
+    }
+    run.last = curr;
+    run.tosses++;
+    return true;
+  };
+
+  auto level = [](const Run& run) { return static_cast<double>(run.tosses); };
+
+  std::vector<double> thresholds;
+  for (size_t tosses = 2; tosses < k; tosses++) {
+    thresholds.push_back(static_cast<double>(tosses));
+  }
+
+  size_t effort = 1000;
+  size_t replicates = 1000;
+
+  auto splitting = [&](auto& rng, ScratchArena& scratch) {
+    return fixed_effort_splitting(rng, scratch, start, advance, level,
+                                  thresholds, effort);
+  };
+
+  auto tail = Estimate::from(
+      runner.run_reduce(splitting, replicates, MeanVariance{}, false), 0.95);
+  std::print("P(experiment lasts at least k tosses) = {:.6e} ± {:.6e} "
+             "({} splitting replicates)\n",
+             tail.mean, tail.half_width, replicates);
 }
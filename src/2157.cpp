@@ -18,13 +18,14 @@ int main() {
     return d1(rng) + d2(rng) + d3(rng) + d4(rng);
   };
 
-  auto results = runner.run(experiment, simulations);
-  auto counts = tally(results);
+  // Saves progress every minute; rerunning after a crash resumes from it.
+  auto counts = runner.run_reduce(experiment, simulations, Histogram<int>{},
+                                  Checkpoint{"2157.ckpt"});
 
   double p_le_3 = 0.0;
   double p_ge_2 = 0.0;
 
-  for (const auto& [k, cnt] : counts) {
+  for (const auto& [k, cnt] : counts.entries()) {
     double freq = static_cast<double>(cnt) / simulations;
 
     std::println("P(X = {}) ≈ {:.6f}", k, freq);
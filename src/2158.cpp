@@ -1,5 +1,5 @@
+#include <cstdlib>
 #include <print>
-#include <random>
 
 #include "task_runner.hpp"
 
@@ -9,27 +9,29 @@ int main() {
   TaskRunner runner;
 
   auto experiment = [](auto& rng) {
-    std::uniform_int_distribution<int> d(1, 6);
-    int a = d(rng);
-    int b = d(rng);
-    int c = d(rng);
+    int a = uniform_int(rng, 1, 6);
+    int b = uniform_int(rng, 1, 6);
+    int c = uniform_int(rng, 1, 6);
     return std::tuple{a, b, c};
   };
 
-  auto results = runner.run(experiment, simulations);
-
-  size_t count_all_five = 0;
-  size_t count_all_equal = 0;
-
-  for (const auto& [a, b, c] : results) {
-    if (a == 5 && b == 5 && c == 5) count_all_five++;
+  auto all_five = [](const auto& dice) {
+    const auto& [a, b, c] = dice;
+    return a == 5 && b == 5 && c == 5;
+  };
 
-    if (a == b && b == c) count_all_equal++;
-  }
+  auto all_equal = [](const auto& dice) {
+    const auto& [a, b, c] = dice;
+    return a == b && b == c;
+  };
 
-  std::println("P(all five) = {:.6f}",
-               static_cast<double>(count_all_five) / simulations);
+  auto exact = runner.enumerate(experiment);
+  auto counts =
+      runner.run_reduce(experiment, simulations, events(all_five, all_equal));
 
-  std::println("P(all equal) = {:.6f}",
-               static_cast<double>(count_all_equal) / simulations);
+  bool agrees = report_probability("P(all five)", counts.hits(0), simulations,
+                                   exact, all_five, 2);
+  agrees &= report_probability("P(all equal)", counts.hits(1), simulations,
+                               exact, all_equal, 2);
+  return agrees ? EXIT_SUCCESS : EXIT_FAILURE;
 }
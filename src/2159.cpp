@@ -1,5 +1,5 @@
+#include <cstdlib>
 #include <print>
-#include <random>
 
 #include "task_runner.hpp"
 
@@ -9,35 +9,37 @@ int main() {
   TaskRunner runner;
 
   auto experiment = [](auto& rng) {
-    std::uniform_int_distribution<int> d(1, 6);
-    int a = d(rng);
-    int b = d(rng);
-    int c = d(rng);
+    int a = uniform_int(rng, 1, 6);
+    int b = uniform_int(rng, 1, 6);
+    int c = uniform_int(rng, 1, 6);
     return std::tuple{a, b, c};
   };
 
-  auto results = runner.run(experiment, simulations);
-
-  size_t count_a = 0;
-  size_t count_b = 0;
-  size_t count_c = 0;
-
-  for (const auto& [a, b, c] : results) {
-    if ((a == 1 && b == 1 && c != 1) || (a == 1 && c == 1 && b != 1) ||
-        (b == 1 && c == 1 && a != 1)) {
-      count_a++;
-    }
+  auto event_a = [](const auto& dice) {
+    const auto& [a, b, c] = dice;
+    return (a == 1 && b == 1 && c != 1) || (a == 1 && c == 1 && b != 1) ||
+           (b == 1 && c == 1 && a != 1);
+  };
 
-    if ((a == b && b != c) || (a == c && c != b) || (b == c && b != a)) {
-      count_b++;
-    }
+  auto event_b = [](const auto& dice) {
+    const auto& [a, b, c] = dice;
+    return (a == b && b != c) || (a == c && c != b) || (b == c && b != a);
+  };
 
-    if (a != b && a != c && b != c) {
-      count_c++;
-    }
-  }
+  auto event_c = [](const auto& dice) {
+    const auto& [a, b, c] = dice;
+    return a != b && a != c && b != c;
+  };
 
-  std::println("P(a) = {:.6f}", static_cast<double>(count_a) / simulations);
-  std::println("P(b) = {:.6f}", static_cast<double>(count_b) / simulations);
-  std::println("P(c) = {:.6f}", static_cast<double>(count_c) / simulations);
+  auto exact = runner.enumerate(experiment);
+  auto counts = runner.run_reduce(experiment, simulations,
+                                  events(event_a, event_b, event_c));
+
+  bool agrees = report_probability("P(a)", counts.hits(0), simulations, exact,
+                                   event_a, 3);
+  agrees &= report_probability("P(b)", counts.hits(1), simulations, exact,
+                               event_b, 3);
+  agrees &= report_probability("P(c)", counts.hits(2), simulations, exact,
+                               event_c, 3);
+  return agrees ? EXIT_SUCCESS : EXIT_FAILURE;
 }
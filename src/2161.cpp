@@ -7,36 +7,31 @@ int main() {
   const double p_hit = 0.8;
   const double limit = 0.4;
   const size_t simulations = 1e7;
+  const double precision = 1e-3;
 
   TaskRunner runner;
 
-  std::bernoulli_distribution hit(p_hit);
-
-  int n = 1;
-  for (;; n++) {
-    auto experiment = [&](auto& rng) {
-      for (int i = 0; i < n; i++) {
-        if (!hit(rng)) {
-          return false;
-        }
-      }
-      return true;
-    };
-
-    auto results = runner.run(experiment, simulations);
-
-    size_t success = 0;
-    for (bool r : results) {
-      if (r) {
-        success++;
-      }
-    }
-
-    double p_all_hit = static_cast<double>(success) / simulations;
-
-    if (p_all_hit < limit) {
-      std::println("n = {}", n);
-      break;
+  // Not all n shots hit exactly when the first miss is among the first n,
+  // so the index of the first miss answers the question for every n.
+  auto first_miss = [p_hit](auto& rng) {
+    std::bernoulli_distribution hit(p_hit);
+    size_t shot = 1;
+    while (hit(rng)) {
+      shot++;
     }
+    return shot;
+  };
+
+  auto search = runner.find_threshold(
+      first_miss,
+      ThresholdSearch{.probability = 1.0 - limit, .half_width = precision},
+      simulations);
+
+  if (search.found) {
+    size_t n = search.parameter;
+    std::println("n = {}", n);
+    std::println("P(all {} hit) = {:.6f} ± {:.6f} ({} simulations)", n,
+                 1.0 - search.estimate.mean, search.estimate.half_width,
+                 search.estimate.simulations);
   }
 }
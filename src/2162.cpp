@@ -1,6 +1,6 @@
+#include <array>
 #include <cmath>
 #include <print>
-#include <random>
 
 #include "task_runner.hpp"
 
@@ -32,62 +32,64 @@ int segment_index(const Point& p) {
   return 3;
 }
 
-int main() {
-  const int simulations = 10000000;
-
-  TaskRunner runner;
-
-  auto experiment = [](auto& rng) {
-    std::uniform_real_distribution<double> d(-1.0, 1.0);
-    int count_triangle = 0;
-    int count_seg1 = 0;
-    int count_seg2 = 0;
-    int count_seg3 = 0;
+// Four points uniform in the unit disk from eight uniforms, in polar
+// coordinates: a radius of sqrt(u) keeps the density uniform.
+std::array<Point, 4> disk_points(const std::array<double, 8>& u) {
+  std::array<Point, 4> points;
+  for (int i = 0; i < 4; i++) {
+    double r = std::sqrt(u[2 * i]);
+    double angle = 2.0 * M_PI * u[2 * i + 1];
+    points[i] = {r * std::cos(angle), r * std::sin(angle)};
+  }
+  return points;
+}
 
-    for (int i = 0; i < 4; i++) {
-      Point p;
-      do {
-        p.x = d(rng);
-        p.y = d(rng);
-      } while (p.x * p.x + p.y * p.y > 1.0);
+struct Regions {
+  int triangle = 0;
+  int seg1 = 0;
+  int seg2 = 0;
+  int seg3 = 0;
+};
 
-      if (inside_triangle(p)) {
-        count_triangle++;
-      } else {
-        int s = segment_index(p);
-        if (s == 1) {
-          count_seg1++;
-        }
-        if (s == 2) {
-          count_seg2++;
-        }
-        if (s == 3) {
-          count_seg3++;
-        }
+Regions count_regions(const std::array<double, 8>& u) {
+  Regions regions;
+  for (const Point& p : disk_points(u)) {
+    if (inside_triangle(p)) {
+      regions.triangle++;
+    } else {
+      int s = segment_index(p);
+      if (s == 1) {
+        regions.seg1++;
+      }
+      if (s == 2) {
+        regions.seg2++;
+      }
+      if (s == 3) {
+        regions.seg3++;
       }
     }
+  }
+  return regions;
+}
 
-    bool a = (count_triangle == 4);
-    bool b = (count_triangle == 1 && count_seg1 == 1 && count_seg2 == 1 &&
-              count_seg3 == 1);
-
-    return std::pair{a, b};
-  };
+int main() {
+  const size_t simulations = 10000000;
 
-  auto results = runner.run(experiment, simulations);
+  TaskRunner runner;
 
-  int count_a = 0;
-  int count_b = 0;
+  // Both events are read off the same region counts, so one pass over the
+  // points estimates the two of them.
+  auto events = [](const std::array<double, 8>& u) {
+    Regions r = count_regions(u);
+    bool a = r.triangle == 4;
+    bool b = r.triangle == 1 && r.seg1 == 1 && r.seg2 == 1 && r.seg3 == 1;
+    return std::array{a, b};
+  };
 
-  for (int i = 0; i < simulations; i++) {
-    if (results[i].first) {
-      count_a++;
-    }
-    if (results[i].second) {
-      count_b++;
-    }
-  }
+  auto [p_a, p_b] = runner.estimate_qmc<8>(events, simulations);
 
-  std::println("P(a) = {:.6f}", double(count_a) / simulations);
-  std::println("P(b) = {:.6f}", double(count_b) / simulations);
+  std::println("P(a) = {:.6f} ± {:.6f} (variance reduction x{:.2f})",
+               p_a.mean, p_a.half_width, p_a.variance_reduction);
+  std::println("P(b) = {:.6f} ± {:.6f} (variance reduction x{:.2f})",
+               p_b.mean, p_b.half_width, p_b.variance_reduction);
 }
@@ -1,37 +1,42 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
 #include <print>
-#include <vector>
+#include <tuple>
 
 #include "task_runner.hpp"
 
-int main() {
-  int simulations = 1e7;
+int main(int argc, char** argv) {
+  size_t simulations = 1e7;
 
   TaskRunner runner;
 
+  // Tickets 0..4 of the 100 are the winning ones.
   auto experiment = [](auto& rng) {
-    std::vector<int> tickets(100);
-    for (int i = 0; i < 100; i++) {
-      tickets[i] = (i < 5) ? 1 : 0;
-    }
+    auto tickets = floyd_sample<2>(100, rng);
 
-    std::shuffle(tickets.begin(), tickets.end(), rng);
-
-    int first = tickets[0];
-    int second = tickets[1];
+    bool first = tickets[0] < 5;
+    bool second = tickets[1] < 5;
 
     return std::tuple{first, second};
   };
 
-  auto results = runner.run(experiment, simulations);
-
-  int count = 0;
+  auto both_winning = [](const auto& tickets) {
+    const auto& [first, second] = tickets;
+    return first && second;
+  };
 
-  for (const auto& [t1, t2] : results) {
-    if (t1 == 1 && t2 == 1) {
-      count++;
-    }
+  // Given a path, every draw is also written there as a column file.
+  auto counts = events(both_winning);
+  try {
+    counts = argc > 1 ? runner.run_reduce(
+                            experiment, simulations, counts,
+                            ResultExport{argv[1], {"first", "second"}})
+                      : runner.run_reduce(experiment, simulations, counts);
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << "\n";
+    return EXIT_FAILURE;
   }
 
-  std::println("P(both tickets are winning) = {:.6f}",
-               static_cast<double>(count) / simulations);
+  std::println("P(both tickets are winning) = {:.6f}", counts.probability(0));
 }
@@ -8,18 +8,14 @@ int main() {
 
   TaskRunner runner;
 
+  // Details 0..5 of the 10 are the painted ones.
   auto experiment = [](auto& rng) {
-    std::vector<int> details(10);
-    for (int i = 0; i < 10; i++) {
-      details[i] = (i < 6) ? 1 : 0;
-    }
-
-    std::shuffle(details.begin(), details.end(), rng);
+    auto details = floyd_sample<4>(10, rng);
 
-    int first = details[0];
-    int second = details[1];
-    int third = details[2];
-    int fourth = details[3];
+    int first = (details[0] < 6) ? 1 : 0;
+    int second = (details[1] < 6) ? 1 : 0;
+    int third = (details[2] < 6) ? 1 : 0;
+    int fourth = (details[3] < 6) ? 1 : 0;
 
     return std::tuple{first, second, third, fourth};
   };
@@ -1,43 +1,47 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <print>
 #include <vector>
 
 #include "task_runner.hpp"
 
 int main() {
-  int simulations = 1e7;
+  size_t simulations = 1e7;
 
   TaskRunner runner;
 
   auto experiment = [](auto& rng) {
-    std::vector<int> balls = {1, 2, 3, 4, 5};
-    std::shuffle(balls.begin(), balls.end(), rng);
+    auto balls = floyd_sample<3>(5, rng);
 
-    int first = balls[0];
-    int second = balls[1];
-    int third = balls[2];
+    int first = balls[0] + 1;
+    int second = balls[1] + 1;
+    int third = balls[2] + 1;
 
     return std::tuple{first, second, third};
   };
 
-  auto results = runner.run(experiment, simulations);
-
-  int count_a = 0;
-  int count_b = 0;
-
-  for (const auto& [b1, b2, b3] : results) {
-    if (b1 == 1 && b2 == 4 && b3 == 5) {
-      count_a++;
-    }
+  auto in_order = [](const auto& balls) {
+    const auto& [b1, b2, b3] = balls;
+    return b1 == 1 && b2 == 4 && b3 == 5;
+  };
 
-    std::vector<int> drawn = {b1, b2, b3};
+  auto any_order = [](const auto& balls) {
+    const auto& [b1, b2, b3] = balls;
+    std::array<int, 3> drawn = {b1, b2, b3};
     std::sort(drawn.begin(), drawn.end());
-    if (drawn[0] == 1 && drawn[1] == 4 && drawn[2] == 5) {
-      count_b++;
-    }
-  }
-
-  std::println("P(exactly 1,4,5 in order) = {:.6f}",
-               static_cast<double>(count_a) / simulations);
-  std::println("P(balls are 1,4,5 in any order) = {:.6f}",
-               static_cast<double>(count_b) / simulations);
+    return drawn[0] == 1 && drawn[1] == 4 && drawn[2] == 5;
+  };
+
+  auto exact = runner.enumerate(experiment);
+  auto counts =
+      runner.run_reduce(experiment, simulations, events(in_order, any_order));
+
+  bool agrees = report_probability("P(exactly 1,4,5 in order)",
+                                   counts.hits(0), simulations, exact,
+                                   in_order, 2);
+  agrees &= report_probability("P(balls are 1,4,5 in any order)",
+                               counts.hits(1), simulations, exact, any_order,
+                               2);
+  return agrees ? EXIT_SUCCESS : EXIT_FAILURE;
 }
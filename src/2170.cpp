@@ -1,56 +1,47 @@
 #include <print>
-#include <random>
-#include <vector>
 
 #include "task_runner.hpp"
 
 int main() {
-  int simulations = 1e7;
+  size_t simulations = 1e7;
+  double relative_error = 1e-3;
 
   TaskRunner runner;
 
+  // Importance sampling for drawing cubes 1, 2, 3 in this order: every draw
+  // picks the wanted cube with probability 0.9 instead of one over the
+  // cubes to choose from, and the likelihood ratio corrects for it. Index 0
+  // stands for the wanted cube; the others are interchangeable.
   auto experiment_without_replacement = [](auto& rng) {
-    std::vector<int> cubes = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
-    std::shuffle(cubes.begin(), cubes.end(), rng);
-
-    int first = cubes[0];
-    int second = cubes[1];
-    int third = cubes[2];
-
-    return std::tuple{first, second, third};
+    LikelihoodRatio ratio;
+    for (size_t left = 10; left > 7; left--) {
+      if (ratio.uniform_index(rng, left, 0, 0.9) != 0) {
+        return 0.0;
+      }
+    }
+    return ratio.weigh(1.0);
   };
 
   auto experiment_with_replacement = [](auto& rng) {
-    std::uniform_int_distribution<int> dist(1, 10);
-
-    int first = dist(rng);
-    int second = dist(rng);
-    int third = dist(rng);
-
-    return std::tuple{first, second, third};
-  };
-
-  auto results_without =
-      runner.run(experiment_without_replacement, simulations);
-  auto results_with = runner.run(experiment_with_replacement, simulations);
-
-  int count_without = 0;
-  int count_with = 0;
-
-  for (const auto& [c1, c2, c3] : results_without) {
-    if (c1 == 1 && c2 == 2 && c3 == 3) {
-      count_without++;
+    LikelihoodRatio ratio;
+    for (int draw = 0; draw < 3; draw++) {
+      if (ratio.uniform_index(rng, 10, 0, 0.9) != 0) {
+        return 0.0;
+      }
     }
-  }
-
-  for (const auto& [c1, c2, c3] : results_with) {
-    if (c1 == 1 && c2 == 2 && c3 == 3) {
-      count_with++;
-    }
-  }
+    return ratio.weigh(1.0);
+  };
 
-  std::println("P(1,2,3 in order without replacement) = {:.6f}",
-               static_cast<double>(count_without) / simulations);
-  std::println("P(1,2,3 in order with replacement) = {:.6f}",
-               static_cast<double>(count_with) / simulations);
+  Precision target{.relative_error = relative_error};
+  auto p_without =
+      runner.run_until(experiment_without_replacement, target, simulations);
+  auto p_with =
+      runner.run_until(experiment_with_replacement, target, simulations);
+
+  std::println("P(1,2,3 in order without replacement) = {:.6f} ± {:.6f} "
+               "({} simulations)",
+               p_without.mean, p_without.half_width, p_without.simulations);
+  std::println("P(1,2,3 in order with replacement) = {:.6f} ± {:.6f} "
+               "({} simulations)",
+               p_with.mean, p_with.half_width, p_with.simulations);
 }
@@ -1,50 +1,45 @@
 #include <print>
 #include <random>
-#include <vector>
 
 #include "task_runner.hpp"
 
 int main() {
-  int simulations = 1e7;
+  size_t simulations = 1e7;
+  double precision = 1e-3;
 
   TaskRunner runner;
 
   double p_head = 0.3;
   double p_student = 0.5;
 
-  for (int n = 0; n <= 5; n++) {
-    auto experiment = [p_head, p_student, n](auto& rng) {
-      std::uniform_real_distribution<double> dist(0.0, 1.0);
+  const size_t max_students = 5;
 
-      bool informed = false;
+  // Whether the news reaches the student for n helpers depends only on the
+  // first helper who passes it on, so one sample path answers every n.
+  auto first_informed = [&](auto& rng) -> size_t {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
 
-      if (dist(rng) < p_head) {
-        informed = true;
-      }
-
-      for (int i = 0; i < n; i++) {
-        if (dist(rng) < p_student) {
-          informed = true;
-        }
-      }
-
-      return informed;
-    };
-
-    auto results = runner.run(experiment, simulations);
-
-    int count = 0;
-    for (bool informed : results) {
-      if (informed) {
-        count++;
-      }
+    if (dist(rng) < p_head) {
+      return 0;
     }
-
-    double probability = static_cast<double>(count) / simulations;
-
-    if (probability > 0.9) {
-      std::println("--> Need n = {} students besides the head", n);
-      break;
+    for (size_t i = 1; i <= max_students; i++) {
+      if (dist(rng) < p_student) {
+        return i;
+      }
     }
+    return max_students + 1;
+  };
+
+  auto search = runner.find_threshold(
+      first_informed,
+      ThresholdSearch{.probability = 0.9, .half_width = precision},
+      simulations);
+
+  if (search.found && search.parameter <= max_students) {
+    std::println("--> Need n = {} students besides the head",
+                 search.parameter);
+    std::println("P(informed) = {:.6f} ± {:.6f} ({} simulations)",
+                 search.estimate.mean, search.estimate.half_width,
+                 search.estimate.simulations);
   }
 }
@@ -1,5 +1,3 @@
-#include <algorithm>
-#include <map>
 #include <print>
 #include <random>
 #include <vector>
@@ -7,7 +5,7 @@
 #include "task_runner.hpp"
 
 int main() {
-  int simulations = 1e7;
+  size_t simulations = 1e7;
 
   TaskRunner runner;
 
@@ -19,18 +17,14 @@ int main() {
     std::println("\n=== Deck size: {} cards ({} values) ===", deck_size,
                  values_count);
 
+    // Card i has value i / 4.
     auto experiment_without_replacement = [deck_size](auto& rng) {
-      std::vector<int> deck(deck_size);
-      for (int i = 0; i < deck_size; i++) {
-        deck[i] = i / 4;
-      }
+      auto hand = floyd_sample<4>(deck_size, rng);
 
-      std::shuffle(deck.begin(), deck.end(), rng);
-
-      int c1 = deck[0];
-      int c2 = deck[1];
-      int c3 = deck[2];
-      int c4 = deck[3];
+      int c1 = hand[0] / 4;
+      int c2 = hand[1] / 4;
+      int c3 = hand[2] / 4;
+      int c4 = hand[3] / 4;
 
       return std::tuple{c1, c2, c3, c4};
     };
@@ -46,87 +40,35 @@ int main() {
       return std::tuple{c1, c2, c3, c4};
     };
 
-    auto results_without =
-        runner.run(experiment_without_replacement, simulations);
-
-    int count_3_1_without = 0;
-    int count_2_2_without = 0;
-    int count_all_diff_without = 0;
-    int count_all_same_without = 0;
-
-    for (const auto& [v1, v2, v3, v4] : results_without) {
-      std::map<int, int> counts;
-      counts[v1]++;
-      counts[v2]++;
-      counts[v3]++;
-      counts[v4]++;
-
-      std::vector<int> freq;
-      for (const auto& [value, cnt] : counts) {
-        freq.push_back(cnt);
-      }
-      std::sort(freq.begin(), freq.end());
-
-      if (freq.size() == 2 && freq[0] == 1 && freq[1] == 3) {
-        count_3_1_without++;
-      } else if (freq.size() == 2 && freq[0] == 2 && freq[1] == 2) {
-        count_2_2_without++;
-      } else if (freq.size() == 4) {
-        count_all_diff_without++;
-      } else if (freq.size() == 1) {
-        count_all_same_without++;
-      }
-    }
+    // Each hand is classified once and every event tests its shape.
+    auto classified = [](const auto& experiment) {
+      return [&](auto& rng) { return multiset_shape(experiment(rng)); };
+    };
+
+    using Shape = MultisetShape<4>;
+    auto three_one = [](Shape shape) { return shape == Shape{3, 1}; };
+    auto two_two = [](Shape shape) { return shape == Shape{2, 2}; };
+    auto all_different = [](Shape shape) { return shape.groups() == 4; };
+    auto all_same = [](Shape shape) { return shape.groups() == 1; };
+
+    auto hands = events(three_one, two_two, all_different, all_same);
+
+    auto report = [](const auto& counts) {
+      std::println("  P(3 cards of one value, 1 of another) = {:.6f}",
+                   counts.probability(0));
+      std::println("  P(2 cards of one value, 2 of another) = {:.6f}",
+                   counts.probability(1));
+      std::println("  P(all different values) = {:.6f}",
+                   counts.probability(2));
+      std::println("  P(all same value) = {:.6f}", counts.probability(3));
+    };
 
     std::println("Without replacement:");
-    std::println("  P(3 cards of one value, 1 of another) = {:.6f}",
-                 static_cast<double>(count_3_1_without) / simulations);
-    std::println("  P(2 cards of one value, 2 of another) = {:.6f}",
-                 static_cast<double>(count_2_2_without) / simulations);
-    std::println("  P(all different values) = {:.6f}",
-                 static_cast<double>(count_all_diff_without) / simulations);
-    std::println("  P(all same value) = {:.6f}",
-                 static_cast<double>(count_all_same_without) / simulations);
-
-    auto results_with = runner.run(experiment_with_replacement, simulations);
-
-    int count_3_1_with = 0;
-    int count_2_2_with = 0;
-    int count_all_diff_with = 0;
-    int count_all_same_with = 0;
-
-    for (const auto& [v1, v2, v3, v4] : results_with) {
-      std::map<int, int> counts;
-      counts[v1]++;
-      counts[v2]++;
-      counts[v3]++;
-      counts[v4]++;
-
-      std::vector<int> freq;
-      for (const auto& [value, cnt] : counts) {
-        freq.push_back(cnt);
-      }
-      std::sort(freq.begin(), freq.end());
-
-      if (freq.size() == 2 && freq[0] == 1 && freq[1] == 3) {
-        count_3_1_with++;
-      } else if (freq.size() == 2 && freq[0] == 2 && freq[1] == 2) {
-        count_2_2_with++;
-      } else if (freq.size() == 4) {
-        count_all_diff_with++;
-      } else if (freq.size() == 1) {
-        count_all_same_with++;
-      }
-    }
+    report(runner.run_reduce(classified(experiment_without_replacement),
+                             simulations, hands));
 
     std::println("With replacement:");
-    std::println("  P(3 cards of one value, 1 of another) = {:.6f}",
-                 static_cast<double>(count_3_1_with) / simulations);
-    std::println("  P(2 cards of one value, 2 of another) = {:.6f}",
-                 static_cast<double>(count_2_2_with) / simulations);
-    std::println("  P(all different values) = {:.6f}",
-                 static_cast<double>(count_all_diff_with) / simulations);
-    std::println("  P(all same value) = {:.6f}",
-                 static_cast<double>(count_all_same_with) / simulations);
+    report(runner.run_reduce(classified(experiment_with_replacement),
+                             simulations, hands));
   }
 }
\ No newline at end of file
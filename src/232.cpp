@@ -16,7 +16,7 @@ int main(const int argc, char* argv[]) {
 
   TaskRunner runner;
 
-  auto experiment = [](std::mt19937& rng) {
+  auto experiment = [](auto& rng) {
     std::vector<int> keys(n);
     std::iota(keys.begin(), keys.end(), 0);
 
@@ -30,8 +30,7 @@ int main(const int argc, char* argv[]) {
     return n;
   };
 
-  auto results = runner.run(experiment, K);
-  auto counts = tally(results);
+  auto counts = runner.run_reduce(experiment, K, Histogram<int>{});
 
   constexpr double p_theory = 1.0 / n;
 
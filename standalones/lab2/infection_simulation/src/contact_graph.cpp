@@ -0,0 +1,388 @@
+#include "contact_graph.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Read-only view of a whole file: mapped where mmap is available, read
+// into memory elsewhere.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      size_t size = static_cast<size_t>(st.st_size);
+      void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        ::madvise(data, size, MADV_SEQUENTIAL);
+        m_mapped = data;
+        m_size = size;
+      }
+    }
+    ::close(fd);
+    if (m_mapped != nullptr || st.st_size == 0) return;
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + path);
+    m_buffer.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+    m_size = m_buffer.size();
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (m_mapped != nullptr) ::munmap(m_mapped, m_size);
+#endif
+  }
+
+  std::string_view data() const {
+    return {m_mapped != nullptr ? static_cast<const char*>(m_mapped)
+                                : m_buffer.data(),
+            m_size};
+  }
+
+ private:
+  void* m_mapped = nullptr;
+  std::vector<char> m_buffer;
+  size_t m_size = 0;
+};
+
+using Edge = std::pair<int, int>;
+
+bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Parses the lines of text into edges; lines that do not start with two
+// integers are skipped.
+void parse_edges(std::string_view text, std::vector<Edge>& edges) {
+  const char* end = text.data() + text.size();
+  for (const char* line = text.data(); line < end;) {
+    auto newline = static_cast<const char*>(
+        std::memchr(line, '\n', static_cast<size_t>(end - line)));
+    const char* eol = newline != nullptr ? newline : end;
+
+    const char* p = line;
+    while (p < eol && is_blank(*p)) p++;
+    int a = 0, b = 0;
+    auto first = std::from_chars(p, eol, a);
+    if (first.ec == std::errc{} && first.ptr < eol && is_blank(*first.ptr)) {
+      p = first.ptr;
+      while (p < eol && is_blank(*p)) p++;
+      if (std::from_chars(p, eol, b).ec == std::errc{})
+        edges.emplace_back(a, b);
+    }
+    line = eol + 1;
+  }
+}
+
+// Runs body(chunk) for chunk = 0 .. chunks - 1 on one thread each.
+template <typename Body>
+void parallel_for(size_t chunks, Body&& body) {
+  std::vector<std::jthread> threads;
+  threads.reserve(chunks);
+  for (size_t c = 0; c < chunks; c++) threads.emplace_back(body, c);
+}
+
+// Header of the binary cache, followed by the ids, offsets and contacts
+// arrays in the machine's own representation.
+struct CacheHeader {
+  char magic[8];
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t nodes;
+  uint64_t contacts;
+  uint64_t checksum;
+};
+
+constexpr char kCacheMagic[8] = {'C', 'S', 'R', 'G', 'R', 'P', 'H', '1'};
+
+static_assert(sizeof(size_t) == sizeof(uint64_t),
+              "the cache stores offsets as 64-bit values");
+
+// Word-at-a-time FNV-style hash, fast enough to check on every load.
+uint64_t checksum(std::string_view bytes, uint64_t hash = 0xcbf29ce484222325) {
+  size_t i = 0;
+  for (; i + 8 <= bytes.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes.data() + i, 8);
+    hash = (hash ^ word) * 0x100000001b3;
+  }
+  for (; i < bytes.size(); i++)
+    hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 0x100000001b3;
+  return hash;
+}
+
+template <typename T>
+std::string_view bytes_of(const std::vector<T>& values) {
+  return {reinterpret_cast<const char*>(values.data()),
+          values.size() * sizeof(T)};
+}
+
+uint64_t checksum(const ContactGraph& graph) {
+  uint64_t hash = checksum(bytes_of(graph.ids));
+  hash = checksum(bytes_of(graph.offsets), hash);
+  return checksum(bytes_of(graph.contacts), hash);
+}
+
+// Size and modification time of the edge list the cache must match.
+struct SourceStamp {
+  uint64_t size;
+  int64_t mtime;
+};
+
+std::optional<SourceStamp> stamp_of(const std::string& path) {
+  std::error_code error;
+  auto size = std::filesystem::file_size(path, error);
+  if (error) return std::nullopt;
+  auto mtime = std::filesystem::last_write_time(path, error);
+  if (error) return std::nullopt;
+  return SourceStamp{size, static_cast<int64_t>(
+                               mtime.time_since_epoch().count())};
+}
+
+// Whether the arrays form a graph the simulation can walk without bounds
+// checks: ids strictly increasing (index_of searches them), offsets
+// starting at 0, never decreasing and ending at the number of contacts,
+// and every contact a node index. The checksum only shows the arrays are
+// the ones that were written, not that they make sense.
+bool is_well_formed(const ContactGraph& graph) {
+  if (graph.offsets.size() != graph.size() + 1 || graph.offsets[0] != 0 ||
+      graph.offsets.back() != graph.contacts.size())
+    return false;
+  if (std::adjacent_find(graph.ids.begin(), graph.ids.end(),
+                         std::greater_equal<>()) != graph.ids.end())
+    return false;
+  if (!std::is_sorted(graph.offsets.begin(), graph.offsets.end()))
+    return false;
+  const auto nodes = static_cast<long long>(graph.size());
+  return std::all_of(graph.contacts.begin(), graph.contacts.end(),
+                     [nodes](int c) { return c >= 0 && c < nodes; });
+}
+
+std::optional<ContactGraph> read_cache(const std::string& cache_path,
+                                       const SourceStamp& source) {
+  std::error_code error;
+  if (!std::filesystem::exists(cache_path, error)) return std::nullopt;
+
+  // A cache that exists but cannot be read is rebuilt like a missing one.
+  std::optional<MappedFile> file;
+  try {
+    file.emplace(cache_path);
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+  std::string_view data = file->data();
+  CacheHeader header;
+  if (data.size() < sizeof(header)) return std::nullopt;
+  std::memcpy(&header, data.data(), sizeof(header));
+  // Counts are bounded by the file size before they are multiplied, so a
+  // damaged header cannot wrap the expected size around.
+  const size_t payload = data.size() - sizeof(header);
+  if (std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+      header.source_size != source.size ||
+      header.source_mtime != source.mtime || header.nodes > payload ||
+      header.contacts > payload ||
+      payload != header.nodes * sizeof(int) +
+                     (header.nodes + 1) * sizeof(size_t) +
+                     header.contacts * sizeof(int))
+    return std::nullopt;
+
+  // The arrays are copied out rather than used in place: offsets follow an
+  // int array and are misaligned for size_t whenever the node count is odd,
+  // the checksum and validation below read every byte anyway, and the graph
+  // keeps owning plain vectors that outlive the mapping.
+  ContactGraph graph;
+  const char* at = data.data() + sizeof(header);
+  auto take = [&](auto& values, size_t count) {
+    values.resize(count);
+    std::memcpy(values.data(), at, count * sizeof(values[0]));
+    at += count * sizeof(values[0]);
+  };
+  take(graph.ids, header.nodes);
+  take(graph.offsets, header.nodes + 1);
+  take(graph.contacts, header.contacts);
+  if (checksum(graph) != header.checksum || !is_well_formed(graph))
+    return std::nullopt;
+  return graph;
+}
+
+// Written to a temporary file and renamed, so readers never see half a
+// cache. Failing to write one (say, a read-only directory) is not an error.
+void write_cache(const std::string& cache_path, const SourceStamp& source,
+                 const ContactGraph& graph) {
+  CacheHeader header;
+  std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.source_size = source.size;
+  header.source_mtime = source.mtime;
+  header.nodes = graph.size();
+  header.contacts = graph.contacts.size();
+  header.checksum = checksum(graph);
+
+  std::string temporary = cache_path + ".tmp";
+  std::FILE* file = std::fopen(temporary.c_str(), "wb");
+  if (file == nullptr) return;
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  for (std::string_view bytes : {bytes_of(graph.ids), bytes_of(graph.offsets),
+                                 bytes_of(graph.contacts)})
+    ok = ok && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(temporary.c_str(), cache_path.c_str()) != 0)
+    std::remove(temporary.c_str());
+}
+
+}  // namespace
+
+ContactGraph load_edge_list(const std::string& path) {
+  MappedFile file(path);
+  std::string_view text = file.data();
+
+  // Split at line boundaries and parse the pieces in parallel.
+  const size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+  const size_t chunks =
+      std::clamp<size_t>(text.size() / (1 << 20), 1, threads);
+  std::vector<size_t> bounds(chunks + 1, text.size());
+  bounds[0] = 0;
+  for (size_t c = 1; c < chunks; c++) {
+    size_t at = std::max(bounds[c - 1], text.size() / chunks * c);
+    size_t newline = text.find('\n', at);
+    bounds[c] = newline == std::string_view::npos ? text.size() : newline + 1;
+  }
+  std::vector<std::vector<Edge>> edges(chunks);
+  parallel_for(chunks, [&](size_t c) {
+    parse_edges(text.substr(bounds[c], bounds[c + 1] - bounds[c]), edges[c]);
+  });
+
+  size_t edge_count = 0;
+  long long min_id = 0, max_id = 0;
+  for (const auto& chunk : edges) {
+    for (const auto& [a, b] : chunk) {
+      if (edge_count++ == 0) min_id = max_id = a;
+      min_id = std::min({min_id, (long long)a, (long long)b});
+      max_id = std::max({max_id, (long long)a, (long long)b});
+    }
+  }
+  if (edge_count == 0)
+    throw std::runtime_error(
+        "No valid edges found. Expected format: two integers per line (e.g. '0 "
+        "1').");
+
+  // Dense indices in increasing id order: through a lookup table when the
+  // ids are compact enough, otherwise by binary search in the sorted ids.
+  ContactGraph graph;
+  const size_t range = static_cast<size_t>(max_id - min_id + 1);
+  std::vector<int> table;
+  if (range <= 4 * edge_count + 1024) {
+    table.assign(range, 0);
+    for (const auto& chunk : edges) {
+      for (const auto& [a, b] : chunk) {
+        table[a - min_id] = 1;
+        table[b - min_id] = 1;
+      }
+    }
+    for (size_t offset = 0; offset < range; offset++) {
+      if (table[offset] == 0) continue;
+      table[offset] = static_cast<int>(graph.ids.size());
+      graph.ids.push_back(static_cast<int>(min_id + (long long)offset));
+    }
+  } else {
+    std::vector<std::vector<int>> chunk_ids(chunks);
+    parallel_for(chunks, [&](size_t c) {
+      auto& ids = chunk_ids[c];
+      ids.reserve(2 * edges[c].size());
+      for (const auto& [a, b] : edges[c]) {
+        ids.push_back(a);
+        ids.push_back(b);
+      }
+      std::sort(ids.begin(), ids.end());
+      ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    });
+    for (const auto& ids : chunk_ids)
+      graph.ids.insert(graph.ids.end(), ids.begin(), ids.end());
+    std::sort(graph.ids.begin(), graph.ids.end());
+    graph.ids.erase(std::unique(graph.ids.begin(), graph.ids.end()),
+                    graph.ids.end());
+  }
+
+  parallel_for(chunks, [&](size_t c) {
+    auto index = [&](int id) {
+      if (!table.empty()) return table[id - min_id];
+      return static_cast<int>(
+          std::lower_bound(graph.ids.begin(), graph.ids.end(), id) -
+          graph.ids.begin());
+    };
+    for (auto& [a, b] : edges[c]) {
+      a = index(a);
+      b = index(b);
+    }
+  });
+
+  if (graph.size() < 2)
+    throw std::runtime_error(
+        "Graph has fewer than 2 nodes. Check that the file is a valid edge "
+        "list.");
+
+  double avg_degree = 2.0 * edge_count / graph.size();
+  if (avg_degree < 1.0)
+    throw std::runtime_error(
+        "Average node degree is less than 1. File likely isn't a valid edge "
+        "list.");
+
+  // Pass one counts degrees, pass two places every contact; edges keep
+  // their order in the file within each node's row.
+  graph.offsets.assign(graph.size() + 1, 0);
+  for (const auto& chunk : edges) {
+    for (const auto& [a, b] : chunk) {
+      graph.offsets[a + 1]++;
+      graph.offsets[b + 1]++;
+    }
+  }
+  for (size_t i = 0; i < graph.size(); i++)
+    graph.offsets[i + 1] += graph.offsets[i];
+
+  graph.contacts.resize(graph.offsets.back());
+  std::vector<size_t> cursor(graph.offsets.begin(), graph.offsets.end() - 1);
+  for (const auto& chunk : edges) {
+    for (const auto& [a, b] : chunk) {
+      graph.contacts[cursor[a]++] = b;
+      graph.contacts[cursor[b]++] = a;
+    }
+  }
+  return graph;
+}
+
+ContactGraph load_contact_graph(const std::string& path) {
+  auto source = stamp_of(path);
+  if (!source) return load_edge_list(path);
+
+  std::string cache_path = path + ".csr";
+  if (auto cached = read_cache(cache_path, *source)) return std::move(*cached);
+
+  ContactGraph graph = load_edge_list(path);
+  write_cache(cache_path, *source, graph);
+  return graph;
+}
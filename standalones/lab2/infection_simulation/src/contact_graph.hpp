@@ -0,0 +1,46 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+// Contact graph in compressed sparse row form: the contacts of node i are
+// contacts[offsets[i]] .. contacts[offsets[i + 1]] in one flat array, so a
+// graph costs a few allocations however many nodes it has. Nodes are dense
+// indices 0 .. size() - 1 in increasing order of their id in the file.
+struct ContactGraph {
+  std::vector<int> ids;         // id of every node as given in the file
+  std::vector<size_t> offsets;  // size() + 1 entries
+  std::vector<int> contacts;    // node indices
+
+  size_t size() const { return ids.size(); }
+  int id_of(size_t node) const { return ids[node]; }
+  // Node with the given id, or -1 if there is none. ids is sorted, so the
+  // mapping needs no table of its own.
+  int index_of(int id) const {
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    return it != ids.end() && *it == id ? static_cast<int>(it - ids.begin())
+                                        : -1;
+  }
+  size_t degree(size_t node) const { return offsets[node + 1] - offsets[node]; }
+  std::span<const int> contacts_of(size_t node) const {
+    return {contacts.data() + offsets[node], degree(node)};
+  }
+};
+
+// Reads an undirected edge list, two integer ids per line separated by
+// blanks; other lines (comments, headers) are skipped. The file is mapped
+// into memory and parsed in parallel chunks, ids are remapped to dense
+// indices and the CSR arrays are built in two passes over the edges.
+// Throws std::runtime_error when the file cannot be read or does not look
+// like an edge list.
+ContactGraph load_edge_list(const std::string& path);
+
+// load_edge_list() through a binary cache kept next to the file as
+// path + ".csr": the CSR arrays behind a small header that records the
+// size and modification time of the edge list they were built from and a
+// checksum of the arrays. A cache that is missing, unreadable, stale,
+// corrupt or not a valid graph is rebuilt from the edge list; otherwise it
+// is memory-mapped and no text is parsed at all.
+ContactGraph load_contact_graph(const std::string& path);
@@ -1,77 +1,103 @@
 #include "simulation.hpp"
 
-#include <fstream>
-#include <sstream>
-#include <stdexcept>
-#include <unordered_map>
-
-Simulation::Simulation(const std::vector<Person>& people, double p_infect,
-                       double p_recover)
-    : m_people(people),
-      p_infect(p_infect),
+#include <algorithm>
+#include <utility>
+
+Simulation::Simulation(ContactGraph graph, double p_infect, double p_recover)
+    : p_infect(p_infect),
       p_recover(p_recover),
-      m_dist(0.0, 1.0),
       m_rng(std::random_device{}()),
+      m_dist(0.0, 1.0),
+      m_graph(std::move(graph)),
+      m_states(m_graph.size(), PersonState::Healthy),
       m_current_step(0) {}
 
-const std::vector<Person>& Simulation::step() {
+void Simulation::reset() {
+    std::fill(m_states.begin(), m_states.end(), PersonState::Healthy);
+    m_infected.clear();
+    m_current_step = 0;
+}
+
+// Only the infected frontier is visited, so a step costs
+// O(infected x degree) rather than a scan of the whole population.
+const std::vector<PersonState>& Simulation::step() {
     if (m_current_step == 0) {
-        std::uniform_int_distribution<size_t> pick(0, m_people.size() - 1);
-        m_people[pick(m_rng)].state = PersonState::Infected;
+        std::uniform_int_distribution<size_t> pick(0, m_states.size() - 1);
+        int first = static_cast<int>(pick(m_rng));
+        m_states[first] = PersonState::Infected;
+        m_infected.push_back(first);
         m_current_step++;
-        return m_people;
+        return m_states;
     }
 
     std::vector<int> newly_infected;
-    for (const auto& person : m_people) {
-        if (person.state != PersonState::Infected) continue;
-        for (int cid : person.contacts) {
-            if ((m_people[cid].state == PersonState::Recovered || m_people[cid].state
-                    == PersonState::Healthy) &&
+    for (int i : m_infected) {
+        for (int cid : m_graph.contacts_of(i)) {
+            if ((m_states[cid] == PersonState::Recovered || m_states[cid] ==
+                    PersonState::Healthy) &&
                 m_dist(m_rng) < p_infect)
                 newly_infected.push_back(cid);
         }
     }
-    for (int id : newly_infected) m_people[id].state = PersonState::Infected;
+    for (int id : newly_infected) {
+        if (m_states[id] == PersonState::Infected) continue;
+        m_states[id] = PersonState::Infected;
+        m_infected.push_back(id);
+    }
 
-    for (auto& person : m_people)
-        if (person.state == PersonState::Infected && m_dist(m_rng) < p_recover)
-            person.state = PersonState::Recovered;
+    // Recovery, compacting the frontier in place.
+    size_t still_infected = 0;
+    for (int id : m_infected) {
+        if (m_dist(m_rng) < p_recover)
+            m_states[id] = PersonState::Recovered;
+        else
+            m_infected[still_infected++] = id;
+    }
+    m_infected.resize(still_infected);
 
     m_current_step++;
-    return m_people;
+    return m_states;
 }
 
-const std::vector<Person>& Simulation::get_people() const { return m_people; }
+const ContactGraph& Simulation::graph() const { return m_graph; }
 
-std::vector<int> Simulation::get_healthy() const {
+const std::vector<PersonState>& Simulation::states() const { return m_states; }
+
+std::vector<int> Simulation::ids_in_state(PersonState state) const {
     std::vector<int> r;
-    for (const auto& p : m_people)
-        if (p.state == PersonState::Healthy) r.push_back(p.id);
+    for (size_t i = 0; i < m_states.size(); i++)
+        if (m_states[i] == state) r.push_back(m_graph.id_of(i));
     return r;
 }
 
+size_t Simulation::count(PersonState state) const {
+    if (state == PersonState::Infected) return m_infected.size();
+    return static_cast<size_t>(
+        std::count(m_states.begin(), m_states.end(), state));
+}
+
+std::vector<int> Simulation::get_healthy() const {
+    return ids_in_state(PersonState::Healthy);
+}
+
 std::vector<int> Simulation::get_infected() const {
     std::vector<int> r;
-    for (const auto& p : m_people)
-        if (p.state == PersonState::Infected) r.push_back(p.id);
+    r.reserve(m_infected.size());
+    for (int i : m_infected) r.push_back(m_graph.id_of(i));
     return r;
 }
 
 std::vector<int> Simulation::get_recovered() const {
-    std::vector<int> r;
-    for (const auto& p : m_people)
-        if (p.state == PersonState::Recovered) r.push_back(p.id);
-    return r;
+    return ids_in_state(PersonState::Recovered);
 }
 
 std::vector<int> Simulation::recovered_with_sick_contacts() const {
     std::vector<int> r;
-    for (const auto& p : m_people) {
-        if (p.state != PersonState::Recovered) continue;
-        for (int cid : p.contacts) {
-            if (m_people[cid].state != PersonState::Recovered) {
-                r.push_back(p.id);
+    for (size_t i = 0; i < m_states.size(); i++) {
+        if (m_states[i] != PersonState::Recovered) continue;
+        for (int cid : m_graph.contacts_of(i)) {
+            if (m_states[cid] != PersonState::Recovered) {
+                r.push_back(m_graph.id_of(i));
                 break;
             }
         }
@@ -81,65 +107,24 @@ std::vector<int> Simulation::recovered_with_sick_contacts() const {
 
 std::vector<int> Simulation::healthy_with_all_infected_contacts() const {
     std::vector<int> r;
-    for (const auto& p : m_people) {
-        if (p.state != PersonState::Healthy) continue;
-        if (p.contacts.empty()) {
+    for (size_t i = 0; i < m_states.size(); i++) {
+        if (m_states[i] != PersonState::Healthy) continue;
+        if (m_graph.degree(i) == 0) {
             continue;
         }
         bool all_gone = true;
-        for (int cid : p.contacts) {
-            if (m_people[cid].state == PersonState::Healthy || m_people[cid].state ==
+        for (int cid : m_graph.contacts_of(i)) {
+            if (m_states[cid] == PersonState::Healthy || m_states[cid] ==
                 PersonState::Recovered) {
                 all_gone = false;
                 break;
             }
         }
-        if (all_gone) r.push_back(p.id);
+        if (all_gone) r.push_back(m_graph.id_of(i));
     }
     return r;
 }
 
-std::vector<Person> Simulation::load_csv(const std::string& csv_path) {
-    std::ifstream file(csv_path);
-    if (!file.is_open())
-        throw std::runtime_error("Cannot open file: " + csv_path);
-
-    std::unordered_map<int, std::vector<int>> adj;
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        std::stringstream ss(line);
-        int a, b;
-        if (!(ss >> a >> b)) continue;
-        adj[a].push_back(b);
-        adj[b].push_back(a);
-    }
-
-    if (adj.empty())
-        throw std::runtime_error(
-            "No valid edges found. Expected format: two integers per line (e.g. '0 "
-            "1').");
-
-    if (adj.size() < 2)
-        throw std::runtime_error(
-            "Graph has fewer than 2 nodes. Check that the file is a valid edge "
-            "list.");
-
-    size_t total_contacts = 0;
-    for (auto& [id, nbrs] : adj) total_contacts += nbrs.size();
-    double avg_degree = (double)total_contacts / adj.size();
-    if (avg_degree < 1.0)
-        throw std::runtime_error(
-            "Average node degree is less than 1. File likely isn't a valid edge "
-            "list.");
-
-    std::vector<Person> people;
-    people.reserve(adj.size());
-    for (auto& [id, neighbours] : adj) {
-        Person p;
-        p.id = id;
-        p.contacts = std::move(neighbours);
-        people.push_back(std::move(p));
-    }
-    return people;
-}
\ No newline at end of file
+ContactGraph Simulation::load_csv(const std::string& csv_path) {
+    return load_contact_graph(csv_path);
+}
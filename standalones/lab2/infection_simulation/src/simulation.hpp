@@ -1,33 +1,44 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <random>
+#include <string>
 #include <vector>
 
-enum class PersonState { Healthy, Infected, Recovered };
+#include "contact_graph.hpp"
 
-struct Person {
-  int id;
-  PersonState state = PersonState::Healthy;
-  std::vector<int> contacts;
-};
+enum class PersonState : uint8_t { Healthy, Infected, Recovered };
 
 class Simulation {
  public:
-  Simulation(const std::vector<Person>& people, double p_infect, double p_recover);
-  const std::vector<Person>& step();
-  const std::vector<Person>& get_people() const;
+  Simulation(ContactGraph graph, double p_infect, double p_recover);
+  const std::vector<PersonState>& step();
+  // Back to step 0 with everyone healthy, keeping the graph.
+  void reset();
+  const ContactGraph& graph() const;
+  // State of every node, one byte each, parallel to graph().ids.
+  const std::vector<PersonState>& states() const;
+  // Number of nodes in `state`, without building the list of their ids.
+  size_t count(PersonState state) const;
   std::vector<int> get_healthy() const;
   std::vector<int> get_infected() const;
   std::vector<int> get_recovered() const;
   std::vector<int> recovered_with_sick_contacts() const;
   std::vector<int> healthy_with_all_infected_contacts() const;
-  static std::vector<Person> load_csv(const std::string& csv_path);
+  // Edge list loader, through its binary cache; see load_contact_graph().
+  static ContactGraph load_csv(const std::string& csv_path);
 
   double p_infect;
   double p_recover;
 
  private:
+  std::vector<int> ids_in_state(PersonState state) const;
+
   std::mt19937 m_rng;
   std::uniform_real_distribution<double> m_dist;
-  std::vector<Person> m_people;
+  ContactGraph m_graph;
+  std::vector<PersonState> m_states;
+  // Nodes currently infected, the only ones step() has to visit.
+  std::vector<int> m_infected;
   size_t m_current_step;
 };
@@ -3,19 +3,30 @@
 #include <QDebug>
 #include <QVariantMap>
 #include <queue>
-#include <unordered_map>
 #include <unordered_set>
 
+namespace {
+
+// Undirected edges are reported once, as a pair of node indices lo < hi.
+struct PairHash {
+  size_t operator()(std::pair<int, int> p) const {
+    return std::hash<long long>()(((long long)p.first << 32) | (unsigned)p.second);
+  }
+};
+
+}  // namespace
+
 SimulationController::SimulationController(QObject* parent) : QObject(parent) {}
 
 void SimulationController::load_graph(const QString& path) {
   m_csv_path = path;
   try {
-    auto people = Simulation::load_csv(path.toStdString());
-    m_sim = std::make_unique<Simulation>(people, m_p_infect, m_p_recover);
+    auto graph = Simulation::load_csv(path.toStdString());
+    m_sim = std::make_unique<Simulation>(std::move(graph), m_p_infect,
+                                         m_p_recover);
     emit stats_changed();
     emit simulation_updated();
-    qDebug() << "Loaded" << m_sim->get_people().size() << "nodes.";
+    qDebug() << "Loaded" << m_sim->graph().size() << "nodes.";
   } catch (const std::exception& e) {
     m_sim.reset();
     qWarning() << "Failed to load graph:" << e.what();
@@ -33,13 +44,21 @@ void SimulationController::step() {
 }
 
 void SimulationController::reset() {
+  if (m_sim) {
+    m_sim->reset();
+    emit stats_changed();
+    emit simulation_updated();
+    qDebug() << "Reset. Nodes:" << m_sim->graph().size();
+    return;
+  }
   if (m_csv_path.isEmpty()) return;
   try {
-    auto people = Simulation::load_csv(m_csv_path.toStdString());
-    m_sim = std::make_unique<Simulation>(people, m_p_infect, m_p_recover);
+    auto graph = Simulation::load_csv(m_csv_path.toStdString());
+    m_sim = std::make_unique<Simulation>(std::move(graph), m_p_infect,
+                                         m_p_recover);
     emit stats_changed();
     emit simulation_updated();
-    qDebug() << "Reset. Nodes:" << m_sim->get_people().size();
+    qDebug() << "Reset. Nodes:" << m_sim->graph().size();
   } catch (const std::exception& e) {
     m_sim.reset();
     qWarning() << "Reset failed:" << e.what();
@@ -56,20 +75,21 @@ void SimulationController::set_recovery_prob(double p) {
   if (m_sim) m_sim->p_recover = p;
 }
 
-int SimulationController::get_healthy_count() const { return m_sim ? (int)m_sim->get_healthy().size() : 0; }
-int SimulationController::get_infected_count() const { return m_sim ? (int)m_sim->get_infected().size() : 0; }
-int SimulationController::get_recovered_count() const { return m_sim ? (int)m_sim->get_recovered().size() : 0; }
+int SimulationController::get_healthy_count() const { return m_sim ? (int)m_sim->count(PersonState::Healthy) : 0; }
+int SimulationController::get_infected_count() const { return m_sim ? (int)m_sim->count(PersonState::Infected) : 0; }
+int SimulationController::get_recovered_count() const { return m_sim ? (int)m_sim->count(PersonState::Recovered) : 0; }
 
 
 QVariantList SimulationController::get_node_states() const {
   QVariantList result;
   if (!m_sim) return result;
-  const auto& people = m_sim->get_people();
-  result.reserve(people.size());
-  for (const auto& p : people) {
+  const auto& graph = m_sim->graph();
+  const auto& states = m_sim->states();
+  result.reserve(graph.size());
+  for (size_t i = 0; i < graph.size(); i++) {
     QVariantMap node;
-    node["id"] = p.id;
-    node["state"] = static_cast<int>(p.state);  // 0=Healthy 1=Infected 2=Recovered
+    node["id"] = graph.id_of(i);
+    node["state"] = static_cast<int>(states[i]);  // 0=Healthy 1=Infected 2=Recovered
     result.append(node);
   }
   return result;
@@ -79,28 +99,26 @@ QVariantList SimulationController::get_edges_for_nodes(const QVariantList& nodeI
   QVariantList result;
   if (!m_sim) return result;
 
-  std::unordered_set<int> idSet;
-  idSet.reserve(nodeIds.size());
-  for (const auto& v : nodeIds) idSet.insert(v.toInt());
-
-  const auto& people = m_sim->get_people();
+  const auto& graph = m_sim->graph();
+  std::vector<int> selected;
+  std::vector<char> inSet(graph.size(), 0);
+  selected.reserve(nodeIds.size());
+  for (const auto& v : nodeIds) {
+    int idx = graph.index_of(v.toInt());
+    if (idx < 0 || inSet[idx]) continue;
+    inSet[idx] = 1;
+    selected.push_back(idx);
+  }
 
-  struct PairHash {
-    size_t operator()(std::pair<int, int> p) const {
-      return std::hash<long long>()(((long long)p.first << 32) | (unsigned)p.second);
-    }
-  };
   std::unordered_set<std::pair<int, int>, PairHash> seen;
-
-  for (const auto& person : people) {
-    if (!idSet.count(person.id)) continue;
-    for (int nb : person.contacts) {
-      if (!idSet.count(nb)) continue;
-      int lo = std::min(person.id, nb), hi = std::max(person.id, nb);
+  for (int idx : selected) {
+    for (int nb : graph.contacts_of(idx)) {
+      if (!inSet[nb]) continue;
+      int lo = std::min(idx, nb), hi = std::max(idx, nb);
       if (seen.insert({lo, hi}).second) {
         QVariantMap edge;
-        edge["a"] = lo;
-        edge["b"] = hi;
+        edge["a"] = graph.id_of(lo);
+        edge["b"] = graph.id_of(hi);
         result.append(edge);
       }
     }
@@ -133,23 +151,20 @@ QVariantMap SimulationController::get_bfs_subgraph(int maxNodes) const {
   QVariantMap result;
   if (!m_sim) return result;
 
-  const auto& people = m_sim->get_people();
-  if (people.empty()) return result;
-
-  std::unordered_map<int, int> idToIdx;
-  idToIdx.reserve(people.size());
-  for (int i = 0; i < (int)people.size(); i++) idToIdx[people[i].id] = i;
+  const auto& graph = m_sim->graph();
+  const auto& states = m_sim->states();
+  if (graph.size() == 0) return result;
 
   int seedIdx = 0;
   size_t bestDeg = 0;
-  for (int i = 0; i < (int)people.size(); i++) {
-    if (people[i].contacts.size() > bestDeg) {
-      bestDeg = people[i].contacts.size();
+  for (int i = 0; i < (int)graph.size(); i++) {
+    if (graph.degree(i) > bestDeg) {
+      bestDeg = graph.degree(i);
       seedIdx = i;
     }
   }
 
-  std::vector<int> visited(people.size(), 0);
+  std::vector<int> visited(graph.size(), 0);
   std::vector<int> order;
   order.reserve(maxNodes);
   std::queue<int> q;
@@ -160,48 +175,36 @@ QVariantMap SimulationController::get_bfs_subgraph(int maxNodes) const {
     int cur = q.front();
     q.pop();
     order.push_back(cur);
-    for (int nb : people[cur].contacts) {
-      auto it = idToIdx.find(nb);
-      if (it == idToIdx.end()) continue;
-      int nbIdx = it->second;
-      if (!visited[nbIdx]) {
-        visited[nbIdx] = 1;
-        q.push(nbIdx);
+    for (int nb : graph.contacts_of(cur)) {
+      if (!visited[nb]) {
+        visited[nb] = 1;
+        q.push(nb);
       }
     }
   }
 
-  std::unordered_map<int, int> subIdx;
-  subIdx.reserve(order.size());
-  for (int si = 0; si < (int)order.size(); si++) subIdx[order[si]] = si;
+  std::vector<char> inSub(graph.size(), 0);
+  for (int idx : order) inSub[idx] = 1;
 
   QVariantList nodes;
   nodes.reserve(order.size());
   for (int idx : order) {
     QVariantMap n;
-    n["id"] = people[idx].id;
-    n["state"] = static_cast<int>(people[idx].state);
+    n["id"] = graph.id_of(idx);
+    n["state"] = static_cast<int>(states[idx]);
     nodes.append(n);
   }
 
-  struct PairHash {
-    size_t operator()(std::pair<int, int> p) const {
-      return std::hash<long long>()(((long long)p.first << 32) | (unsigned)p.second);
-    }
-  };
   std::unordered_set<std::pair<int, int>, PairHash> seen;
   QVariantList edges;
   for (int idx : order) {
-    for (int nb : people[idx].contacts) {
-      auto it = idToIdx.find(nb);
-      if (it == idToIdx.end()) continue;
-      if (subIdx.find(it->second) == subIdx.end()) continue;
-      int lo = std::min(people[idx].id, nb);
-      int hi = std::max(people[idx].id, nb);
+    for (int nb : graph.contacts_of(idx)) {
+      if (!inSub[nb]) continue;
+      int lo = std::min(idx, nb), hi = std::max(idx, nb);
       if (seen.insert({lo, hi}).second) {
         QVariantMap e;
-        e["a"] = lo;
-        e["b"] = hi;
+        e["a"] = graph.id_of(lo);
+        e["b"] = graph.id_of(hi);
         edges.append(e);
       }
     }